@@ -0,0 +1,161 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP 1
+#endif
+
+// Общее для снимков на диске (task 7 - множества, task 8 - выражения):
+// файл, отображённый в память только для чтения, и запись секций
+// с выравниванием через временный файл
+namespace common {
+    constexpr size_t kSectionAlign = 64;  // Секции выровнены по кеш-линии
+
+    constexpr size_t alignUp(size_t n) {
+        return (n + kSectionAlign - 1) / kSectionAlign * kSectionAlign;
+    }
+
+    // Файл, отображённый в память только для чтения
+    // Без POSIX просто читается целиком
+    class MappedFile {
+        const std::byte* data_ = nullptr;
+        size_t size_ = 0;
+#ifndef MAPPED_FILE_MMAP
+        std::vector<uint64_t> buffer_;
+#endif
+
+    public:
+        explicit MappedFile(const std::string& path) {
+#ifdef MAPPED_FILE_MMAP
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("cannot open snapshot " + path);
+            struct stat st{};
+            if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+                ::close(fd);
+                throw std::runtime_error("cannot stat snapshot " + path);
+            }
+            size_ = static_cast<size_t>(st.st_size);
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);  // Отображение остаётся действительным и после закрытия
+            if (addr == MAP_FAILED) throw std::runtime_error("cannot mmap snapshot " + path);
+            data_ = static_cast<const std::byte*>(addr);
+#else
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            if (!in) throw std::runtime_error("cannot open snapshot " + path);
+            size_ = static_cast<size_t>(in.tellg());
+            buffer_.resize((size_ + 7) / 8);
+            in.seekg(0);
+            in.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(size_));
+            data_ = reinterpret_cast<const std::byte*>(buffer_.data());
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+#ifdef MAPPED_FILE_MMAP
+            ::munmap(const_cast<std::byte*>(data_), size_);
+#endif
+        }
+
+        // Подсказка ОС не читать наперёд: к хеш-таблице обращаются вразброс
+        void adviseRandom() const {
+#ifdef MAPPED_FILE_MMAP
+            ::madvise(const_cast<std::byte*>(data_), size_, MADV_RANDOM);
+#endif
+        }
+
+        const std::byte* data() const { return data_; }
+        size_t size() const { return size_; }
+
+        // Секция из count элементов по смещению offset с проверкой границ
+        template<class U>
+        std::span<const U> section(size_t offset, size_t count) const {
+            if (offset > size_ || count > (size_ - offset) / sizeof(U)) {
+                throw std::runtime_error("corrupted snapshot: section out of bounds");
+            }
+            return {reinterpret_cast<const U*>(data_ + offset), count};
+        }
+    };
+
+    // Сбрасывает файл (или каталог) на диск; без POSIX - ничего не делает
+    inline bool syncPath(const std::string& path) {
+#ifdef MAPPED_FILE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+#else
+        (void)path;
+        return true;
+#endif
+    }
+
+    // Последовательная запись секций с выравниванием.
+    // Пишется во временный файл path + ".tmp", который finish() переименовывает
+    // в path. Снимок, открытый из того же пути, до конца читает старый файл
+    // (отображение держит его), а прерванная запись не портит существующий снимок
+    class SnapshotWriter {
+        std::string path_, tmpPath_;
+        std::ofstream out_;
+        size_t written_ = 0;
+        bool finished_ = false;
+
+    public:
+        explicit SnapshotWriter(const std::string& path)
+            : path_(path), tmpPath_(path + ".tmp"), out_(tmpPath_, std::ios::binary | std::ios::trunc) {
+            if (!out_) throw std::runtime_error("cannot create snapshot " + tmpPath_);
+        }
+
+        SnapshotWriter(const SnapshotWriter&) = delete;
+        SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+        // Запись не завершена (исключение по дороге) - временный файл не нужен
+        ~SnapshotWriter() {
+            if (finished_) return;
+            out_.close();
+            std::remove(tmpPath_.c_str());
+        }
+
+        template<class U>
+        void write(std::span<const U> data) {
+            out_.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size_bytes()));
+            written_ += data.size_bytes();
+            static const char zeros[kSectionAlign] = {};
+            size_t pad = alignUp(written_) - written_;
+            out_.write(zeros, static_cast<std::streamsize>(pad));
+            written_ += pad;
+        }
+
+        // Данные - на диск, затем переименование поверх path: после сбоя
+        // по пути лежит либо старый снимок, либо новый целиком
+        void finish() {
+            out_.close();
+            if (!out_ || !syncPath(tmpPath_)) throw std::runtime_error("failed to write snapshot " + tmpPath_);
+            std::error_code error;
+            std::filesystem::rename(tmpPath_, path_, error);
+            if (error) throw std::runtime_error("cannot replace snapshot " + path_ + ": " + error.message());
+            finished_ = true;
+            auto dir = std::filesystem::path(path_).parent_path();
+            syncPath(dir.empty() ? "." : dir.string());
+        }
+    };
+}
+
+#endif //MAPPEDFILE_H
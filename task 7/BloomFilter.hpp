@@ -0,0 +1,76 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Блочный фильтр Блума: все k бит ключа лежат в одном 512-битном блоке,
+// то есть в одной кеш-линии, поэтому проверка стоит не больше одного промаха кеша.
+// Ложные срабатывания возможны, ложные отрицания - нет. Удаления не поддерживаются.
+// Фильтр не знает типа ключа: принимает уже посчитанный хеш и перемешивает его сам,
+// так что подходит и тождественный std::hash для целых
+class BlockedBloomFilter {
+    static constexpr unsigned kBlockBits = 512;
+
+    struct alignas(64) Block {
+        uint64_t words[kBlockBits / 64] = {};
+    };
+
+    std::vector<Block> blocks_;
+    unsigned hashes_ = 1;  // Число бит на ключ (k)
+
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 33; x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    // Старшие 32 бита хеша выбирают блок (умножением вместо деления по модулю),
+    // младшие 32 порождают k позиций внутри блока двойным хешированием
+    size_t blockIndex(uint64_t h) const {
+        return (h >> 32) * blocks_.size() >> 32;
+    }
+
+public:
+    // Размер подбирается под ожидаемое число элементов и желаемую долю ложных срабатываний.
+    // Блочная схема теряет немного точности, поэтому берём на 20% больше бит
+    BlockedBloomFilter(size_t expectedElements, double falsePositiveRate) {
+        const double ln2 = std::log(2.0);
+        double bitsPerKey = -std::log(falsePositiveRate) / (ln2 * ln2) * 1.2;
+        hashes_ = static_cast<unsigned>(std::clamp(std::lround(bitsPerKey / 1.2 * ln2), 1L, 16L));
+        double bits = std::max(1.0, static_cast<double>(expectedElements)) * bitsPerKey;
+        blocks_.resize(static_cast<size_t>(std::ceil(bits / kBlockBits)));
+    }
+
+    void add(uint64_t hash) {
+        uint64_t h = mix(hash);
+        Block& block = blocks_[blockIndex(h)];
+        uint32_t h1 = static_cast<uint32_t>(h), h2 = (h1 >> 16) | (h1 << 16) | 1;
+        for (unsigned i = 0; i < hashes_; ++i) {
+            uint32_t bit = (h1 + i * h2) % kBlockBits;
+            block.words[bit / 64] |= uint64_t{1} << (bit % 64);
+        }
+    }
+
+    // false - значения точно нет; true - возможно есть
+    bool mayContain(uint64_t hash) const {
+        uint64_t h = mix(hash);
+        const Block& block = blocks_[blockIndex(h)];
+        uint32_t h1 = static_cast<uint32_t>(h), h2 = (h1 >> 16) | (h1 << 16) | 1;
+        bool result = true;
+        for (unsigned i = 0; i < hashes_; ++i) {
+            uint32_t bit = (h1 + i * h2) % kBlockBits;
+            result &= (block.words[bit / 64] >> (bit % 64)) & 1;
+        }
+        return result;
+    }
+
+    size_t memoryUsage() const {
+        return blocks_.size() * sizeof(Block);
+    }
+};
+
+#endif //BLOOMFILTER_H
@@ -0,0 +1,269 @@
+#ifndef COMPRESSEDSETIMPL_H
+#define COMPRESSEDSETIMPL_H
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include "SetImpl.hpp"
+
+// Неизменяемое сжатое множество для больших статичных наборов
+// Элементы хранятся по возрастанию блоками по kBlockSize: первый элемент блока
+// лежит в индексе пропусков (skip index), остальные - разностями с предыдущим,
+// упакованными фиксированной для блока шириной в битах.
+// Поиск: бинарный поиск по индексу пропусков + распаковка одного блока.
+// Массивы могут принадлежать самому объекту или лежать во внешней памяти
+// (например, в отображённом файле снимка) - см. View.
+// Доступно только для целочисленных ключей
+template<class T>
+concept PackableInteger = std::integral<T> && !std::same_as<T, bool>;
+
+template<PackableInteger T>
+class CompressedSetImpl : public SetImpl<T> {
+public:
+    static constexpr size_t kBlockSize = 128;
+
+    using Key = std::make_unsigned_t<T>;
+
+    // Сырые массивы представления: для записи на диск и работы поверх чужой памяти
+    struct View {
+        size_t size = 0;
+        std::span<const Key> blockFirst;
+        std::span<const uint64_t> blockOffset;
+        std::span<const uint8_t> blockWidth;
+        std::span<const uint64_t> bits;
+    };
+
+private:
+    static constexpr Key kSignFlip = std::is_signed_v<T> ? Key(Key(1) << (8 * sizeof(T) - 1)) : Key(0);
+
+    // Ключ со сдвинутым знаковым битом: беззнаковый порядок совпадает с порядком T
+    static Key toKey(T value) { return static_cast<Key>(static_cast<Key>(value) ^ kSignFlip); }
+    static T fromKey(Key key) { return static_cast<T>(static_cast<Key>(key ^ kSignFlip)); }
+
+    // Собственные массивы (пусты, если объект смотрит во внешнюю память)
+    struct Storage {
+        std::vector<Key> blockFirst;
+        std::vector<uint64_t> blockOffset;
+        std::vector<uint8_t> blockWidth;
+        std::vector<uint64_t> bits;
+    };
+    Storage storage_;
+    std::shared_ptr<const void> owner_;  // Держит внешнюю память живой
+
+    size_t size_ = 0;
+    std::span<const Key> blockFirst_;         // Первый ключ каждого блока
+    std::span<const uint64_t> blockOffset_;   // Смещение разностей блока в битах
+    std::span<const uint8_t> blockWidth_;     // Ширина разности в битах
+    std::span<const uint64_t> bits_;          // Упакованные разности (+1 слово запаса для чтения)
+
+    Key readBits(uint64_t pos, unsigned width) const {
+        if (width == 0) return 0;
+        size_t word = pos >> 6;
+        unsigned shift = pos & 63;
+        uint64_t v = bits_[word] >> shift;
+        if (shift + width > 64) v |= bits_[word + 1] << (64 - shift);
+        uint64_t mask = width == 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+        return static_cast<Key>(v & mask);
+    }
+
+    void writeBits(uint64_t pos, unsigned width, uint64_t value) {
+        if (width == 0) return;
+        size_t word = pos >> 6;
+        unsigned shift = pos & 63;
+        storage_.bits[word] |= value << shift;
+        if (shift + width > 64) storage_.bits[word + 1] |= value >> (64 - shift);
+    }
+
+    size_t blockCount() const { return blockFirst_.size(); }
+
+public:
+    // Курсор по элементам в порядке возрастания
+    // Кроме ++ умеет seek - перескакивать целые блоки через индекс пропусков
+    class const_iterator {
+        const CompressedSetImpl* set_ = nullptr;
+        size_t index_ = 0;    // Номер текущего элемента
+        Key key_ = 0;         // Текущий ключ
+        uint64_t bitPos_ = 0; // Позиция следующей разности
+
+        void loadBlock(size_t block) {
+            index_ = block * kBlockSize;
+            if (index_ >= set_->size_) { index_ = set_->size_; return; }
+            key_ = set_->blockFirst_[block];
+            bitPos_ = set_->blockOffset_[block];
+        }
+
+        friend class CompressedSetImpl;
+        const_iterator(const CompressedSetImpl* set, size_t block) : set_(set) { loadBlock(block); }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = T;
+
+        const_iterator() = default;
+
+        T operator*() const { return fromKey(key_); }
+
+        const_iterator& operator++() {
+            if (++index_ >= set_->size_) { index_ = set_->size_; return *this; }
+            if (index_ % kBlockSize == 0) {
+                loadBlock(index_ / kBlockSize);
+            } else {
+                unsigned width = set_->blockWidth_[index_ / kBlockSize];
+                key_ += static_cast<Key>(set_->readBits(bitPos_, width) + 1);
+                bitPos_ += width;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) { auto copy = *this; ++*this; return copy; }
+
+        // Переходит к первому элементу >= value (только вперёд)
+        void seek(T value) {
+            Key key = toKey(value);
+            if (index_ >= set_->size_ || key_ >= key) return;
+            size_t block = index_ / kBlockSize;
+            const auto& first = set_->blockFirst_;
+            if (block + 1 < first.size() && first[block + 1] <= key) {
+                // Нужный элемент в одном из следующих блоков: ищем последний блок с first <= key
+                auto it = std::upper_bound(first.begin() + static_cast<std::ptrdiff_t>(block) + 1, first.end(), key);
+                loadBlock(static_cast<size_t>(it - first.begin()) - 1);
+            }
+            while (index_ < set_->size_ && key_ < key) ++*this;
+        }
+
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+    };
+
+    // Строит сжатое представление; values могут быть неупорядочены и содержать повторы
+    explicit CompressedSetImpl(std::vector<T> values) {
+        std::vector<Key> keys(values.size());
+        std::transform(values.begin(), values.end(), keys.begin(), toKey);
+        values = {};
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        size_ = keys.size();
+        size_t blocks = (size_ + kBlockSize - 1) / kBlockSize;
+        storage_.blockFirst.reserve(blocks);
+        storage_.blockOffset.reserve(blocks);
+        storage_.blockWidth.reserve(blocks);
+
+        // Первый проход: ширины блоков и общий объём
+        uint64_t totalBits = 0;
+        for (size_t b = 0; b < blocks; ++b) {
+            size_t begin = b * kBlockSize, end = std::min(begin + kBlockSize, size_);
+            Key maxDelta = 0;
+            for (size_t i = begin + 1; i < end; ++i) maxDelta = std::max(maxDelta, Key(keys[i] - keys[i - 1] - 1));
+            unsigned width = static_cast<unsigned>(std::bit_width(maxDelta));
+            storage_.blockFirst.push_back(keys[begin]);
+            storage_.blockOffset.push_back(totalBits);
+            storage_.blockWidth.push_back(static_cast<uint8_t>(width));
+            totalBits += uint64_t{width} * (end - begin - 1);
+        }
+
+        // Второй проход: упаковка разностей
+        storage_.bits.assign(totalBits / 64 + 2, 0);
+        for (size_t b = 0; b < blocks; ++b) {
+            size_t begin = b * kBlockSize, end = std::min(begin + kBlockSize, size_);
+            uint64_t pos = storage_.blockOffset[b];
+            for (size_t i = begin + 1; i < end; ++i, pos += storage_.blockWidth[b]) {
+                writeBits(pos, storage_.blockWidth[b], Key(keys[i] - keys[i - 1] - 1));
+            }
+        }
+
+        blockFirst_ = storage_.blockFirst;
+        blockOffset_ = storage_.blockOffset;
+        blockWidth_ = storage_.blockWidth;
+        bits_ = storage_.bits;
+    }
+
+    // Работает поверх чужих массивов без копирования; owner держит их память
+    CompressedSetImpl(const View& view, std::shared_ptr<const void> owner)
+        : owner_(std::move(owner)), size_(view.size), blockFirst_(view.blockFirst),
+          blockOffset_(view.blockOffset), blockWidth_(view.blockWidth), bits_(view.bits) {}
+
+    // Спаны смотрят в storage_, поэтому копирование запрещено
+    CompressedSetImpl(const CompressedSetImpl&) = delete;
+    CompressedSetImpl& operator=(const CompressedSetImpl&) = delete;
+
+    View view() const {
+        return {size_, blockFirst_, blockOffset_, blockWidth_, bits_};
+    }
+
+    bool isReadOnly() const override {
+        return true;
+    }
+
+    void add(const T&) override {
+        throw std::logic_error("CompressedSetImpl is immutable");
+    }
+
+    void remove(const T&) override {
+        throw std::logic_error("CompressedSetImpl is immutable");
+    }
+
+    bool contains(const T& value) const override {
+        if (size_ == 0) return false;
+        Key key = toKey(value);
+        auto it = std::upper_bound(blockFirst_.begin(), blockFirst_.end(), key);
+        if (it == blockFirst_.begin()) return false;
+        size_t block = static_cast<size_t>(it - blockFirst_.begin()) - 1;
+
+        Key cur = blockFirst_[block];
+        unsigned width = blockWidth_[block];
+        uint64_t pos = blockOffset_[block];
+        size_t len = std::min(kBlockSize, size_ - block * kBlockSize);
+        for (size_t i = 1; i < len && cur < key; ++i, pos += width) {
+            cur += static_cast<Key>(readBits(pos, width) + 1);
+        }
+        return cur == key;
+    }
+
+    std::vector<T> elements() const override {
+        std::vector<T> result;
+        result.reserve(size_);
+        for (T v : *this) result.push_back(v);
+        return result;
+    }
+
+    size_t size() const override {
+        return size_;
+    }
+
+    size_t memoryUsage() const override {
+        return blockFirst_.size_bytes() + blockOffset_.size_bytes()
+             + blockWidth_.size_bytes() + bits_.size_bytes();
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, blockCount()); }
+
+    // Пересечение методом "чехарды": каждый курсор перескакивает к текущему
+    // элементу другого, пропуская целые блоки без распаковки. Результат упорядочен
+    std::vector<T> intersect(const CompressedSetImpl& other) const {
+        std::vector<T> result;
+        auto a = begin(), aEnd = end();
+        auto b = other.begin(), bEnd = other.end();
+        while (a != aEnd && b != bEnd) {
+            T va = *a, vb = *b;
+            if (va == vb) {
+                result.push_back(va);
+                ++a; ++b;
+            } else if (va < vb) {
+                a.seek(vb);
+            } else {
+                b.seek(va);
+            }
+        }
+        return result;
+    }
+};
+
+#endif //COMPRESSEDSETIMPL_H
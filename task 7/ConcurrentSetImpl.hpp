@@ -0,0 +1,338 @@
+#ifndef CONCURRENTSETIMPL_H
+#define CONCURRENTSETIMPL_H
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include "SetImpl.hpp"
+#include "EpochDomain.hpp"
+
+// Потокобезопасная lock-free реализация множества
+// Открытая адресация с линейным пробированием; каждый слот - одно 64-битное
+// атомарное слово: старшие биты хранят состояние, младшие 32 - значение.
+// Удаление оставляет надгробие с ключом, поэтому ключ никогда не "переезжает"
+// внутри таблицы, и все операции сводятся к CAS одного слова.
+// Расширение кооперативное: поток, заметивший новую таблицу, помогает
+// перенести в неё слоты старой порциями, прежде чем работать дальше.
+// Вышедшие из употребления таблицы освобождаются по эпохам (см. EpochDomain).
+// Только для int: значение должно помещаться в слот рядом с состоянием
+class ConcurrentSetImpl : public SetImpl<int> {
+    // Состояния слота
+    static constexpr uint64_t kEmpty = 0;   // Никогда не занимался
+    static constexpr uint64_t kLive = 1;    // Содержит значение
+    static constexpr uint64_t kTomb = 2;    // Значение удалено, ключ сохранён
+    static constexpr uint64_t kFrozen = 3;  // Живое значение, переносится в новую таблицу
+    static constexpr uint64_t kMoved = 4;   // Слот перенесён, искать в следующей таблице
+
+    static constexpr size_t kMinCapacity = 64;
+    static constexpr size_t kCopyChunk = 1024;   // Порция слотов, переносимая одним потоком
+    static constexpr size_t kResizeSlack = 256;  // Запас под вставки, идущие во время переноса
+
+    static uint64_t pack(uint64_t state, int value) {
+        return state << 32 | static_cast<uint32_t>(value);
+    }
+    static uint64_t stateOf(uint64_t slot) { return slot >> 32; }
+    static int valueOf(uint64_t slot) { return static_cast<int>(static_cast<uint32_t>(slot)); }
+
+    static size_t hashOf(int value) {
+        uint32_t x = static_cast<uint32_t>(value);
+        x ^= x >> 16; x *= 0x7feb352dU;
+        x ^= x >> 15; x *= 0x846ca68bU;
+        x ^= x >> 16;
+        return x;
+    }
+
+    struct Table {
+        size_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+        std::atomic<size_t> used{0};          // Слоты, занятые ключом (включая надгробия)
+        std::atomic<Table*> next{nullptr};    // Таблица, в которую идёт перенос
+        std::atomic<size_t> copyCursor{0};    // Начало следующей незанятой порции
+        std::atomic<size_t> copyDone{0};      // Сколько слотов уже перенесено
+        Table* retiredNext = nullptr;         // Список таблиц, ждущих освобождения
+        uint64_t retiredAt = 0;               // Эпоха, в которой таблицу вывели из обращения
+
+        explicit Table(size_t capacity)
+            : mask(capacity - 1), slots(std::make_unique<std::atomic<uint64_t>[]>(capacity)) {}
+
+        size_t capacity() const { return mask + 1; }
+    };
+
+    std::atomic<Table*> table_;      // Текущая таблица
+    std::atomic<long long> size_{0};
+
+    // Выведенные из обращения таблицы ждут здесь, пока их не перестанут
+    // читать (см. task_7::EpochDomain): продвинуть эпоху и освободить пробует grow()
+    std::atomic<Table*> retired_{nullptr};       // Стек выведенных таблиц
+    std::atomic<size_t> retiredBytes_{0};
+    std::atomic<bool> reclaiming_{false};        // Список разбирает один поток
+
+    static size_t bytesOf(const Table* t) { return t->capacity() * sizeof(uint64_t); }
+
+    // Таблица больше недоступна через table_: в список на освобождение
+    void retire(Table* t) {
+        t->retiredAt = task_7::EpochDomain::instance().epoch();
+        retiredBytes_.fetch_add(bytesOf(t), std::memory_order_relaxed);
+        t->retiredNext = retired_.load(std::memory_order_relaxed);
+        while (!retired_.compare_exchange_weak(t->retiredNext, t)) {}
+    }
+
+    // Продвигает эпоху, если можно, и освобождает таблицы, которые уже никто не читает
+    void reclaim() {
+        auto& domain = task_7::EpochDomain::instance();
+        domain.tryAdvance();
+        const uint64_t now = domain.tryAdvance();
+        if (reclaiming_.exchange(true, std::memory_order_acquire)) return;
+        Table* list = retired_.exchange(nullptr);
+        while (list) {
+            Table* t = list;
+            list = t->retiredNext;
+            if (t->retiredAt + 2 <= now) {
+                retiredBytes_.fetch_sub(bytesOf(t), std::memory_order_relaxed);
+                delete t;
+            } else {
+                t->retiredNext = retired_.load(std::memory_order_relaxed);
+                while (!retired_.compare_exchange_weak(t->retiredNext, t)) {}
+            }
+        }
+        reclaiming_.store(false, std::memory_order_release);
+    }
+
+    // Результат попытки операции над конкретной таблицей
+    enum class Step { Done, Retry };
+
+    // Вставляет значение в таблицу назначения при переносе, если ключа там ещё нет.
+    // Найденное надгробие означает, что значение уже перенесли и удалили - не воскрешаем
+    static void copyInto(Table* to, int value) {
+        size_t i = hashOf(value) & to->mask;
+        for (size_t n = 0; n <= to->mask; ++n, i = (i + 1) & to->mask) {
+            uint64_t s = to->slots[i].load(std::memory_order_acquire);
+            while (stateOf(s) == kEmpty) {
+                if (to->slots[i].compare_exchange_weak(s, pack(kLive, value), std::memory_order_acq_rel)) {
+                    to->used.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            // kMoved: перенос этой таблицы начался, значит наш слот уже перенесён кем-то другим
+            if (stateOf(s) == kMoved || valueOf(s) == value) return;
+        }
+        assert(false && "destination table is full");
+    }
+
+    // Переносит один слот; идемпотентна, её может выполнять любой поток
+    static void copySlot(Table* from, Table* to, size_t i) {
+        auto& slot = from->slots[i];
+        uint64_t s = slot.load(std::memory_order_acquire);
+        while (true) {
+            uint64_t st = stateOf(s);
+            if (st == kMoved) return;
+            if (st == kEmpty || st == kTomb) {
+                if (slot.compare_exchange_weak(s, pack(kMoved, 0), std::memory_order_acq_rel)) return;
+                continue;
+            }
+            if (st == kLive) {
+                // Замораживаем, чтобы удаление не проскочило между копированием и пометкой
+                if (!slot.compare_exchange_weak(s, pack(kFrozen, valueOf(s)), std::memory_order_acq_rel)) continue;
+                s = pack(kFrozen, valueOf(s));
+            }
+            copyInto(to, valueOf(s));
+            slot.compare_exchange_strong(s, pack(kMoved, 0), std::memory_order_acq_rel);
+            return;
+        }
+    }
+
+    // Помогает завершить перенос from -> from->next и продвигает текущую таблицу
+    void helpCopy(Table* from) {
+        Table* to = from->next.load(std::memory_order_acquire);
+        const size_t cap = from->capacity();
+        while (from->copyDone.load(std::memory_order_acquire) < cap) {
+            size_t start = from->copyCursor.fetch_add(kCopyChunk, std::memory_order_relaxed);
+            if (start >= cap) {
+                // Все порции разобраны, но кто-то ещё не закончил. Не ждём его,
+                // а сами проходим таблицу: перенесённые слоты стоят одну загрузку
+                for (size_t i = 0; i < cap; ++i) copySlot(from, to, i);
+                break;
+            }
+            size_t end = std::min(start + kCopyChunk, cap);
+            for (size_t i = start; i < end; ++i) copySlot(from, to, i);
+            from->copyDone.fetch_add(end - start, std::memory_order_acq_rel);
+        }
+        Table* expected = from;
+        // seq_cst: порядок с объявлениями эпох читателей (см. EpochDomain::enter)
+        if (table_.compare_exchange_strong(expected, to)) retire(from);
+    }
+
+    // Создаёт следующую таблицу (если её ещё нет) и участвует в переносе
+    void grow(Table* t) {
+        if (!t->next.load(std::memory_order_acquire)) {
+            size_t live = static_cast<size_t>(std::max(size_.load(std::memory_order_relaxed), 0LL));
+            size_t capacity = std::bit_ceil(std::max(kMinCapacity, 2 * live + kResizeSlack));
+            auto* fresh = new Table(capacity);
+            Table* expected = nullptr;
+            if (!t->next.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) {
+                delete fresh;  // Другой поток успел раньше
+            }
+        }
+        helpCopy(t);
+        reclaim();
+    }
+
+    // Возвращает таблицу, над которой можно выполнять изменения:
+    // если идёт перенос, сначала помогаем его закончить
+    Table* writableTable() {
+        Table* t = table_.load();  // seq_cst: см. EpochDomain::enter
+        while (Table* next = t->next.load(std::memory_order_acquire)) {
+            helpCopy(t);
+            t = next;
+        }
+        return t;
+    }
+
+    Step tryAdd(Table* t, int value) {
+        size_t i = hashOf(value) & t->mask;
+        for (size_t n = 0; n <= t->mask; ++n, i = (i + 1) & t->mask) {
+            auto& slot = t->slots[i];
+            uint64_t s = slot.load(std::memory_order_acquire);
+            while (true) {
+                uint64_t st = stateOf(s);
+                if (st == kEmpty) {
+                    // Заполненность считаем до захвата слота, чтобы пробы оставались короткими
+                    if (4 * (t->used.load(std::memory_order_relaxed) + 1) > 3 * t->capacity()) {
+                        grow(t);
+                        return Step::Retry;
+                    }
+                    if (slot.compare_exchange_weak(s, pack(kLive, value), std::memory_order_acq_rel)) {
+                        t->used.fetch_add(1, std::memory_order_relaxed);
+                        size_.fetch_add(1, std::memory_order_relaxed);
+                        return Step::Done;
+                    }
+                    continue;
+                }
+                if (st == kMoved) {
+                    helpCopy(t);
+                    return Step::Retry;
+                }
+                if (valueOf(s) != value) break;  // Чужой ключ - идём дальше
+                if (st == kLive || st == kFrozen) return Step::Done;
+                // Надгробие с нашим ключом - оживляем его
+                if (slot.compare_exchange_weak(s, pack(kLive, value), std::memory_order_acq_rel)) {
+                    size_.fetch_add(1, std::memory_order_relaxed);
+                    return Step::Done;
+                }
+            }
+        }
+        grow(t);
+        return Step::Retry;
+    }
+
+    Step tryRemove(Table* t, int value) {
+        size_t i = hashOf(value) & t->mask;
+        for (size_t n = 0; n <= t->mask; ++n, i = (i + 1) & t->mask) {
+            auto& slot = t->slots[i];
+            uint64_t s = slot.load(std::memory_order_acquire);
+            while (true) {
+                uint64_t st = stateOf(s);
+                if (st == kEmpty) return Step::Done;
+                if (st == kMoved || (st == kFrozen && valueOf(s) == value)) {
+                    helpCopy(t);
+                    return Step::Retry;
+                }
+                if (valueOf(s) != value) break;
+                if (st == kTomb) return Step::Done;
+                if (slot.compare_exchange_weak(s, pack(kTomb, value), std::memory_order_acq_rel)) {
+                    size_.fetch_sub(1, std::memory_order_relaxed);
+                    return Step::Done;
+                }
+            }
+        }
+        return Step::Done;
+    }
+
+public:
+    ConcurrentSetImpl() : table_(new Table(kMinCapacity)) {}
+
+    ConcurrentSetImpl(const ConcurrentSetImpl&) = delete;
+    ConcurrentSetImpl& operator=(const ConcurrentSetImpl&) = delete;
+
+    // Параллельных операций уже нет: освобождаем текущую цепочку и всё,
+    // что ещё ждёт своей эпохи
+    ~ConcurrentSetImpl() override {
+        for (Table* t = table_.load(); t != nullptr; ) {
+            Table* next = t->next.load();
+            delete t;
+            t = next;
+        }
+        for (Table* t = retired_.load(); t != nullptr; ) {
+            Table* next = t->retiredNext;
+            delete t;
+            t = next;
+        }
+    }
+
+    void add(const int& value) override {
+        task_7::EpochGuard guard;
+        while (tryAdd(writableTable(), value) == Step::Retry) {}
+    }
+
+    void remove(const int& value) override {
+        task_7::EpochGuard guard;
+        while (tryRemove(writableTable(), value) == Step::Retry) {}
+    }
+
+    // Чтение пишет только в запись эпохи своего потока (отдельная кеш-линия)
+    // и не помогает переносу: перенесённые слоты просто отправляют поиск
+    // в следующую таблицу
+    bool contains(const int& value) const override {
+        task_7::EpochGuard guard;
+        Table* t = table_.load();  // seq_cst: см. EpochDomain::enter
+        while (t != nullptr) {
+            size_t i = hashOf(value) & t->mask;
+            for (size_t n = 0; n <= t->mask; ++n, i = (i + 1) & t->mask) {
+                uint64_t s = t->slots[i].load(std::memory_order_acquire);
+                uint64_t st = stateOf(s);
+                if (st == kEmpty) return false;
+                if (st == kMoved) break;
+                if (valueOf(s) == value) return st != kTomb;
+            }
+            t = t->next.load(std::memory_order_acquire);
+        }
+        return false;
+    }
+
+    // Не атомарный снимок: элементы, изменяемые параллельно, могут попасть или не попасть
+    std::vector<int> elements() const override {
+        task_7::EpochGuard guard;
+        std::vector<int> result;
+        Table* t;
+        do {
+            // Если во время обхода начался перенос, перенесённые слоты пропали бы - повторяем
+            t = const_cast<ConcurrentSetImpl*>(this)->writableTable();
+            result.clear();
+            result.reserve(size());
+            for (size_t i = 0; i < t->capacity(); ++i) {
+                uint64_t s = t->slots[i].load(std::memory_order_acquire);
+                if (stateOf(s) == kLive || stateOf(s) == kFrozen) result.push_back(valueOf(s));
+            }
+        } while (t->next.load(std::memory_order_acquire) != nullptr);
+        return result;
+    }
+
+    size_t size() const override {
+        return static_cast<size_t>(std::max(size_.load(std::memory_order_relaxed), 0LL));
+    }
+
+    // Текущая таблица, таблицы, в которые идёт перенос, и выведенные из
+    // обращения, но ещё не освобождённые
+    size_t memoryUsage() const override {
+        task_7::EpochGuard guard;
+        size_t bytes = retiredBytes_.load(std::memory_order_relaxed);
+        for (Table* t = table_.load(); t != nullptr; t = t->next.load(std::memory_order_acquire)) {
+            bytes += bytesOf(t);
+        }
+        return bytes;
+    }
+};
+
+#endif //CONCURRENTSETIMPL_H
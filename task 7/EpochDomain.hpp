@@ -0,0 +1,126 @@
+#ifndef EPOCHDOMAIN_H
+#define EPOCHDOMAIN_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace task_7 {
+    // Запись потока в EpochDomain: эпоха, объявленная при входе в защищённый
+    // участок, и бит активности. Каждая запись - на своей кеш-линии, поэтому
+    // вход и выход читателя пишут только в линию своего потока
+    struct alignas(64) EpochRecord {
+        std::atomic<uint64_t> announced{0};  // epoch << 1 | 1, пока поток внутри участка; 0 - снаружи
+        std::atomic<bool> inUse{false};       // Запись занята живым потоком
+        EpochRecord* next = nullptr;          // Список всех записей (только растёт)
+        unsigned depth = 0;                   // Вложенность EpochGuard (меняет только владелец)
+    };
+
+    // Освобождение памяти по эпохам (общее на процесс).
+    // Поток перед обращением к разделяемым узлам объявляет текущую эпоху в своей
+    // записи. Эпоха g переходит в g + 1, только когда все активные потоки
+    // объявили g. Узел, выведенный из обращения в эпоху t, могут держать лишь
+    // потоки, объявившие не больше t, - он освобождается при эпохе t + 2.
+    // Продвигать эпоху пробует тот, кому есть что освобождать; никто не ждёт
+    class EpochDomain {
+        alignas(64) std::atomic<uint64_t> epoch_{0};
+        alignas(64) std::atomic<EpochRecord*> records_{nullptr};
+
+        // Возвращает запись завершившегося потока в общий пул
+        struct Owner {
+            EpochRecord* record;
+
+            ~Owner() {
+                record->announced.store(0, std::memory_order_release);
+                record->inUse.store(false, std::memory_order_release);
+            }
+        };
+
+        // Свободная запись или новая, добавленная в список
+        EpochRecord* acquire() {
+            for (EpochRecord* r = records_.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+                bool expected = false;
+                if (!r->inUse.load(std::memory_order_relaxed) &&
+                    r->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    return r;
+                }
+            }
+            auto* r = new EpochRecord;
+            r->inUse.store(true, std::memory_order_relaxed);
+            r->next = records_.load(std::memory_order_relaxed);
+            while (!records_.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {}
+            return r;
+        }
+
+        EpochDomain() = default;
+
+    public:
+        // Не разрушается: записи потоков нужны до завершения последнего из них
+        static EpochDomain& instance() {
+            static EpochDomain* domain = new EpochDomain;
+            return *domain;
+        }
+
+        EpochDomain(const EpochDomain&) = delete;
+        EpochDomain& operator=(const EpochDomain&) = delete;
+
+        EpochRecord& local() {
+            thread_local Owner owner{acquire()};
+            return *owner.record;
+        }
+
+        // Объявление эпохи - запись только в свою линию. Если эпоха успела
+        // смениться до объявления, объявляем заново: иначе продвигающий поток
+        // мог не увидеть нас и уйти на две эпохи вперёд.
+        // Объявление, проверка и чтение разделяемых указателей после входа -
+        // seq_cst (на x86 загрузка seq_cst - обычный mov)
+        void enter(EpochRecord& r) {
+            if (r.depth++ > 0) return;
+            uint64_t e = epoch_.load(std::memory_order_relaxed);
+            while (true) {
+                r.announced.store(e << 1 | 1);
+                uint64_t now = epoch_.load();
+                if (now == e) return;
+                e = now;
+            }
+        }
+
+        void exit(EpochRecord& r) {
+            if (--r.depth == 0) r.announced.store(0, std::memory_order_release);
+        }
+
+        // Эпоха для метки выведенного узла: читать после того, как узел
+        // стал недоступен (seq_cst-операцией)
+        uint64_t epoch() const { return epoch_.load(); }
+
+        // Продвигает эпоху на один шаг, если все активные потоки объявили текущую.
+        // Возвращает эпоху после попытки
+        uint64_t tryAdvance() {
+            uint64_t e = epoch_.load();
+            for (EpochRecord* r = records_.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+                uint64_t a = r->announced.load();
+                if ((a & 1) && (a >> 1) != e) return e;
+            }
+            epoch_.compare_exchange_strong(e, e + 1);
+            return epoch_.load();
+        }
+    };
+
+    // Защищённый участок: пока guard жив, узлы, прочитанные из разделяемых
+    // указателей, не освобождаются. Вложенные guard одного потока допустимы
+    class EpochGuard {
+        EpochDomain& domain;
+        EpochRecord& record;
+
+    public:
+        EpochGuard() : domain(EpochDomain::instance()), record(domain.local()) {
+            domain.enter(record);
+        }
+
+        EpochGuard(const EpochGuard&) = delete;
+        EpochGuard& operator=(const EpochGuard&) = delete;
+
+        ~EpochGuard() { domain.exit(record); }
+    };
+}
+
+#endif //EPOCHDOMAIN_H
@@ -0,0 +1,351 @@
+#ifndef SET_H
+#define SET_H
+
+#include <iostream>
+#include <memory>
+#include <cassert>
+#include "SetImpl.hpp"
+#include "CompressedSetImpl.hpp"
+#include "BloomFilter.hpp"
+#include "SetSnapshot.hpp"
+
+// Сжатое представление есть только у целочисленных ключей
+template<class T>
+struct FrozenSetImpl {
+    using type = void;
+};
+
+template<PackableInteger T>
+struct FrozenSetImpl<T> {
+    using type = CompressedSetImpl<T>;
+};
+
+// Абстракция множества с автоматическим переключением реализаций
+// Переключается между векторной и хеш-табличной реализацией
+// при достижении порогового размера (kThreshold)
+// Параметризовано типом ключа, хешем и равенством; особенности
+// представления под конкретный тип задаются в SetTraits
+template<class T = int, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
+class Set {
+    using Impl = SetImpl<T>;
+    using VectorImpl = VectorSetImpl<T, Hash, KeyEqual>;
+    using HashImpl = HashSetImpl<T, Hash, KeyEqual>;
+    using FrozenImpl = typename FrozenSetImpl<T>::type;
+
+    // Замораживание возможно, только если ключи упаковываются CompressedSetImpl
+    // и сравниваются как обычные целые
+    static constexpr bool kCanFreeze = PackableInteger<T> && std::is_same_v<KeyEqual, std::equal_to<T>>;
+
+    // Во входе, отсортированном по operator<, равные по KeyEqual ключи стоят
+    // рядом, только если KeyEqual - обычное равенство. Более грубое равенство
+    // (например, без учёта регистра) разносит их по входу
+    static constexpr bool kSortedRunsAreEqualKeys =
+        std::is_same_v<KeyEqual, std::equal_to<T>> || std::is_same_v<KeyEqual, std::equal_to<>>;
+
+    std::unique_ptr<Impl> impl;  // Текущая реализация
+    [[no_unique_address]] Hash hasher;
+    
+    // Пороговое значение для переключения реализаций
+    static constexpr size_t kThreshold = SetTraits<T>::kThreshold;
+
+    // Фильтр Блума перед contains (необязательный, см. enableBloomFilter)
+    // Имеет смысл только для больших множеств, маленькие и так лежат в кеше
+    static constexpr size_t kBloomMinSize = 1024;
+    std::unique_ptr<BlockedBloomFilter> bloom;
+    double bloomFalsePositiveRate = 0;  // 0 - фильтр выключен
+    size_t bloomCapacity = 0;           // На сколько элементов рассчитан текущий фильтр
+    size_t bloomStale = 0;              // Удалено после построения (их биты остались в фильтре)
+
+    explicit Set(std::unique_ptr<Impl> i) : impl(std::move(i)) {}
+
+    const FrozenImpl* frozen() const {
+        if constexpr (kCanFreeze) {
+            return dynamic_cast<const FrozenImpl*>(impl.get());
+        } else {
+            return nullptr;
+        }
+    }
+
+    // Сжатое и отображённое из файла представления неизменяемы: перед изменением
+    // переносим элементы в обычную реализацию, выбранную по размеру
+    void thaw() {
+        if (!impl->isReadOnly()) return;
+        if constexpr (kCanFreeze) {
+            if (frozen()) {
+                impl = std::move(from_sorted_range(impl->elements()).impl);
+                return;
+            }
+        }
+        impl = std::move(from_range(impl->elements()).impl);
+    }
+
+    // Перестраивает фильтр Блума с запасом в четверть под рост
+    void rebuildBloom() {
+        bloomCapacity = std::max(impl->size() + impl->size() / 4, kBloomMinSize);
+        bloomStale = 0;
+        bloom = std::make_unique<BlockedBloomFilter>(bloomCapacity, bloomFalsePositiveRate);
+        for (const T& v : impl->elements()) bloom->add(hasher(v));
+    }
+
+    // Поддерживает фильтр после изменения множества: строит его, когда множество
+    // стало большим, и перестраивает, когда он переполнен или засорён удалёнными
+    void maintainBloom() {
+        if (bloomFalsePositiveRate == 0) return;
+        size_t sz = impl->size();
+        if (sz < kBloomMinSize / 2) {
+            bloom.reset();
+        } else if (bloom ? sz > bloomCapacity || bloomStale > sz / 2 : sz >= kBloomMinSize) {
+            rebuildBloom();
+        }
+    }
+    
+    // Переключает реализацию при необходимости
+    // На основе текущего размера множества
+    void SwitchImpl() {
+        size_t sz = impl->size();
+        bool usingHashNow = dynamic_cast<HashImpl*>(impl.get()) != nullptr;
+        if (usingHashNow == (sz > kThreshold)) return;  // Текущая реализация уже подходит
+
+#ifdef DEBUGPRINT
+        std::string to = usingHashNow ? "vector" : "hash";
+        std::cout << "SWITCHING TO " << to << " implementation with size: " << sz << std::endl;
+#endif
+
+        // Переключаемся на хеш-таблицу, если размер превысил порог и сейчас вектор
+        if (!usingHashNow && sz > kThreshold) {
+            auto elems = impl->elements();
+            auto hash = std::make_unique<HashImpl>();
+            hash->addRange(elems);
+            impl = std::move(hash);
+        } 
+        // Возвращаемся к вектору, если размер уменьшился до порога и сейчас хеш-таблица
+        else if (usingHashNow && sz <= kThreshold) {
+            impl = std::make_unique<VectorImpl>(impl->elements());
+        }
+    }
+
+public:
+    // По умолчанию используем векторную реализацию
+    Set() : impl(std::make_unique<VectorImpl>()) {}
+
+    // Строит множество из произвольного диапазона за один проход:
+    // большие входы дедуплицируются хешированием в заранее зарезервированную таблицу,
+    // маленькие (не больше kThreshold) - прямо в векторе
+    static Set from_range(std::span<const T> values) {
+        if (values.size() <= kThreshold) {
+            auto vec = std::make_unique<VectorImpl>();
+            vec->addRange(values);
+            return Set(std::move(vec));
+        }
+
+        auto hash = std::make_unique<HashImpl>();
+        hash->addRange(values);
+        Set result(std::move(hash));
+        // После дедупликации элементов могло остаться мало
+        if (result.impl->size() <= kThreshold) result.SwitchImpl();
+        return result;
+    }
+
+    // Быстрый путь для отсортированного (по operator<) входа: дубликаты соседние,
+    // поэтому итоговый размер известен до выбора реализации. С KeyEqual,
+    // отличным от std::equal_to, соседство не гарантировано - тогда общий путь
+    static Set from_sorted_range(std::span<const T> values) {
+        assert(std::is_sorted(values.begin(), values.end()));
+        if constexpr (!kSortedRunsAreEqualKeys) {
+            return from_range(values);
+        } else {
+            KeyEqual equal;
+
+            size_t unique = values.empty() ? 0 : 1;
+            for (size_t i = 1; i < values.size(); ++i) {
+                unique += !equal(values[i], values[i - 1]);
+            }
+
+            if (unique <= kThreshold) {
+                std::vector<T> data;
+                data.reserve(unique);
+                std::unique_copy(values.begin(), values.end(), std::back_inserter(data), equal);
+                return Set(std::make_unique<VectorImpl>(std::move(data)));
+            }
+
+            auto hash = std::make_unique<HashImpl>();
+            hash->reserve(unique);
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (i == 0 || !equal(values[i], values[i - 1])) hash->add(values[i]);
+            }
+            return Set(std::move(hash));
+        }
+    }
+
+    void add(const T& value) {
+        thaw();
+        impl->add(value);
+        // Проверяем необходимость переключения после добавления
+        if (impl->size() == kThreshold + 1) {
+            SwitchImpl();
+        }
+        if (bloom) bloom->add(hasher(value));
+        maintainBloom();
+    }
+
+    // Добавляет диапазон: если результат заведомо не поместится в вектор,
+    // переходим на хеш-таблицу один раз до вставки, а не посреди неё
+    void add_range(std::span<const T> values) {
+        thaw();
+        bool usingHashNow = dynamic_cast<HashImpl*>(impl.get()) != nullptr;
+        if (!usingHashNow && impl->size() + values.size() > kThreshold) {
+            auto hash = std::make_unique<HashImpl>();
+            hash->reserve(impl->size() + values.size());
+            hash->addRange(impl->elements());
+            impl = std::move(hash);
+        }
+        impl->addRange(values);
+        if (impl->size() <= kThreshold) SwitchImpl();
+        if (bloom) {
+            for (const T& v : values) bloom->add(hasher(v));
+        }
+        maintainBloom();
+    }
+    
+    void remove(const T& value) {
+        thaw();
+        size_t before = impl->size();
+        impl->remove(value);
+        bloomStale += before - impl->size();
+        // Проверяем необходимость переключения после удаления
+        if (impl->size() == kThreshold) {
+            SwitchImpl();
+        }
+        maintainBloom();
+    }
+
+    // Удаляет диапазон, проверяя порог один раз в конце
+    void remove_range(std::span<const T> values) {
+        thaw();
+        size_t before = impl->size();
+        impl->removeRange(values);
+        bloomStale += before - impl->size();
+        if (impl->size() <= kThreshold) SwitchImpl();
+        maintainBloom();
+    }
+    
+    bool contains(const T& value) const {
+        // Отрицательный ответ фильтра - одна кеш-линия вместо похода в таблицу
+        if (bloom && !bloom->mayContain(hasher(value))) return false;
+        return impl->contains(value);
+    }
+
+    size_t size() const {
+        return impl->size();
+    }
+
+    size_t memoryUsage() const {
+        return impl->memoryUsage() + (bloom ? bloom->memoryUsage() : 0);
+    }
+
+    // Включает фильтр Блума с заданной долей ложных срабатываний
+    // Фильтр строится, только пока множество не меньше kBloomMinSize
+    void enableBloomFilter(double falsePositiveRate = 0.01) {
+        assert(falsePositiveRate > 0 && falsePositiveRate < 1);
+        bloomFalsePositiveRate = falsePositiveRate;
+        bloom.reset();
+        maintainBloom();
+    }
+
+    void disableBloomFilter() {
+        bloomFalsePositiveRate = 0;
+        bloom.reset();
+    }
+
+    // Текущий фильтр или nullptr, если он выключен или множество мало
+    const BlockedBloomFilter* bloomFilter() const {
+        return bloom.get();
+    }
+
+    // Переводит множество в сжатое неизменяемое представление
+    // Следующее изменение автоматически распакует его обратно
+    void freeze() requires kCanFreeze {
+        if (frozen()) return;
+        impl = std::make_unique<FrozenImpl>(impl->elements());
+    }
+
+    bool isFrozen() const {
+        return frozen() != nullptr;
+    }
+
+    // Сохраняет снимок в формате текущего представления: сжатое - как есть,
+    // маленькое - отсортированным массивом, большое - хеш-таблицей.
+    // Путь может совпадать с тем, из которого множество открыто (см. SnapshotWriter)
+    void save(const std::string& path) const requires kCanFreeze {
+        if (auto c = frozen()) {
+            task_7::writeCompressedSnapshot(path, *c);
+        } else if (impl->size() <= kThreshold) {
+            task_7::writeSortedArraySnapshot(path, impl->elements());
+        } else {
+            task_7::writeHashTableSnapshot(path, impl->elements());
+        }
+    }
+
+    // Открывает снимок через mmap: множество сразу готово к чтению,
+    // страницы подгружаются при первом обращении. Первое изменение
+    // переносит элементы в память (см. thaw)
+    static Set open(const std::string& path) requires kCanFreeze {
+        return Set(task_7::openSnapshot<T>(path));
+    }
+
+    // Обходит элементы по возрастанию
+    template<class F>
+    void forEachOrdered(F f) const {
+        if constexpr (kCanFreeze) {
+            if (auto c = frozen()) {
+                for (T v : *c) f(v);
+                return;
+            }
+        }
+        auto elems = impl->elements();
+        std::sort(elems.begin(), elems.end());
+        for (const T& v : elems) f(v);
+    }
+    
+    // Возвращает объединение двух множеств
+    // Создает новое множество, содержащее все элементы из обоих множеств
+    Set setUnion(const Set& other) const {
+        Set result;
+        result.add_range(impl->elements());
+        result.add_range(other.impl->elements());
+        return result;
+    }
+    
+    // Возвращает пересечение двух множеств
+    // Создает новое множество, содержащее только общие элементы
+    Set setIntersection(const Set& other) const {
+        // Оба сжаты - пересекаем по индексам пропусков без полной распаковки
+        if constexpr (kCanFreeze) {
+            if (frozen() && other.frozen()) {
+                return from_sorted_range(frozen()->intersect(*other.frozen()));
+            }
+        }
+        // Иначе перебираем меньшее множество и ищем в большем
+        const Set& small = size() <= other.size() ? *this : other;
+        const Set& large = size() <= other.size() ? other : *this;
+        std::vector<T> common;
+        for (const T& v : small.impl->elements()) {
+            if (large.contains(v)) {
+                common.push_back(v);
+            }
+        }
+        return from_range(common);
+    }
+    
+    // Выводит содержимое множества в удобочитаемом формате
+    void print() const {
+        auto elems = impl->elements();
+        std::cout << "{";
+        for (size_t i = 0; i < elems.size(); ++i) {
+            std::cout << elems[i] << (i+1 < elems.size() ? ", " : "");
+        }
+        std::cout << "}\n";
+    }
+};
+
+#endif //SET_H
@@ -0,0 +1,217 @@
+#ifndef SETIMPL_H
+#define SETIMPL_H
+
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <functional>
+#include <span>
+#include <type_traits>
+
+// Выбор представления под тип ключа
+// Целые сравниваются за такт, и линейный поиск по вектору векторизуется,
+// а для строк и прочих "дорогих" ключей выгоднее сначала сравнить хеши
+template<class T>
+struct SetTraits {
+    // Порог переключения вектор <-> хеш-таблица
+    static constexpr size_t kThreshold = 10;
+
+    // Хранить ли в векторной реализации хеши рядом с ключами
+    static constexpr bool kCacheHash = !std::is_trivially_copyable_v<T>;
+
+    // Линейный поиск без ветвлений, который компилятор разворачивает в SIMD
+    static constexpr bool kBranchlessScan = std::is_integral_v<T>;
+};
+
+// Базовый интерфейс для реализации множества
+// Определяет основные операции работы с множеством
+template<class T>
+class SetImpl {
+public:
+    virtual ~SetImpl() = default;
+
+    // Добавляет элемент в множество (если его там нет)
+    virtual void add(const T& value) = 0;
+
+    // Удаляет элемент из множества
+    virtual void remove(const T& value) = 0;
+
+    // Проверяет наличие элемента в множестве
+    virtual bool contains(const T& value) const = 0;
+
+    // Возвращает все элементы множества в виде вектора
+    virtual std::vector<T> elements() const = 0;
+
+    // Количество элементов (без копирования, в отличие от elements().size())
+    virtual size_t size() const = 0;
+
+    // Приблизительный объём занимаемой памяти в байтах
+    virtual size_t memoryUsage() const = 0;
+
+    // Неизменяемые представления (сжатое, отображённое из файла) бросают
+    // исключение на add/remove; Set перед изменением переводит их в обычные
+    virtual bool isReadOnly() const {
+        return false;
+    }
+
+    // Пакетное добавление: по умолчанию просто поэлементно
+    virtual void addRange(std::span<const T> values) {
+        for (const T& v : values) add(v);
+    }
+
+    // Пакетное удаление: по умолчанию просто поэлементно
+    virtual void removeRange(std::span<const T> values) {
+        for (const T& v : values) remove(v);
+    }
+};
+
+// Реализация множества на основе вектора
+// Оптимальна для небольших множеств (до 10 элементов)
+template<class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
+class VectorSetImpl : public SetImpl<T> {
+    static constexpr bool kCacheHash = SetTraits<T>::kCacheHash;
+    static constexpr bool kBranchlessScan =
+        SetTraits<T>::kBranchlessScan && std::is_same_v<KeyEqual, std::equal_to<T>>;
+
+    struct NoHashes {};
+
+    std::vector<T> data;  // Хранение элементов в векторе
+    // Хеши элементов (только для типов с kCacheHash), data[i] <-> hashes[i]
+    [[no_unique_address]] std::conditional_t<kCacheHash, std::vector<size_t>, NoHashes> hashes;
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] KeyEqual equal;
+
+    // Индекс элемента или data.size(), если его нет
+    size_t find(const T& value) const {
+        if constexpr (kCacheHash) {
+            size_t h = hasher(value);
+            for (size_t i = 0; i < data.size(); ++i) {
+                if (hashes[i] == h && equal(data[i], value)) return i;
+            }
+        } else {
+            for (size_t i = 0; i < data.size(); ++i) {
+                if (equal(data[i], value)) return i;
+            }
+        }
+        return data.size();
+    }
+
+public:
+    VectorSetImpl() = default;
+
+    // Принимает уже дедуплицированные элементы (для пакетной загрузки)
+    explicit VectorSetImpl(std::vector<T> unique) : data(std::move(unique)) {
+        if constexpr (kCacheHash) {
+            hashes.reserve(data.size());
+            for (const T& v : data) hashes.push_back(hasher(v));
+        }
+    }
+
+    void add(const T& value) override {
+        if (!contains(value)) {
+            data.push_back(value);  // Добавляем только уникальные элементы
+            if constexpr (kCacheHash) hashes.push_back(hasher(value));
+        }
+    }
+
+    void remove(const T& value) override {
+        // В множестве не более одного вхождения
+        size_t i = find(value);
+        if (i == data.size()) return;
+        data.erase(data.begin() + static_cast<std::ptrdiff_t>(i));
+        if constexpr (kCacheHash) hashes.erase(hashes.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    bool contains(const T& value) const override {
+        if constexpr (kBranchlessScan) {
+            // Без раннего выхода: цикл сворачивается в векторные сравнения
+            bool found = false;
+            for (const T& v : data) found |= v == value;
+            return found;
+        } else {
+            return find(value) != data.size();
+        }
+    }
+
+    std::vector<T> elements() const override {
+        return data;  // Возвращаем копию вектора
+    }
+
+    size_t size() const override {
+        return data.size();
+    }
+
+    size_t memoryUsage() const override {
+        size_t bytes = data.capacity() * sizeof(T);
+        if constexpr (kCacheHash) bytes += hashes.capacity() * sizeof(size_t);
+        return bytes;
+    }
+
+    // Один проход по вектору вместо values.size() вызовов remove
+    void removeRange(std::span<const T> values) override {
+        std::unordered_set<T, Hash, KeyEqual> doomed(values.begin(), values.end());
+        size_t kept = 0;
+        for (size_t i = 0; i < data.size(); ++i) {
+            if (doomed.contains(data[i])) continue;
+            if (kept != i) {
+                data[kept] = std::move(data[i]);
+                if constexpr (kCacheHash) hashes[kept] = hashes[i];
+            }
+            ++kept;
+        }
+        data.resize(kept);
+        if constexpr (kCacheHash) hashes.resize(kept);
+    }
+};
+
+// Реализация множества на основе хеш-таблицы
+// Оптимальна для больших множеств (более 10 элементов)
+template<class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
+class HashSetImpl : public SetImpl<T> {
+    std::unordered_set<T, Hash, KeyEqual> data;  // Хранение элементов в хеш-таблице
+
+public:
+    void add(const T& value) override {
+        data.insert(value);  // insert автоматически проверяет уникальность
+    }
+
+    void remove(const T& value) override {
+        data.erase(value);
+    }
+
+    bool contains(const T& value) const override {
+        return data.contains(value);
+    }
+
+    std::vector<T> elements() const override {
+        return std::vector<T>(data.begin(), data.end());
+    }
+
+    size_t size() const override {
+        return data.size();
+    }
+
+    // Массив корзин плюс по узлу на элемент: указатель, значение,
+    // хеш (для "дорогих" ключей таблица его кеширует) и служебные байты аллокатора
+    size_t memoryUsage() const override {
+        constexpr size_t node = sizeof(void*) + sizeof(T) + 2 * sizeof(void*)
+                              + (SetTraits<T>::kCacheHash ? sizeof(size_t) : 0);
+        return data.bucket_count() * sizeof(void*) + data.size() * node;
+    }
+
+    // Резервирует корзины заранее, чтобы избежать повторных rehash
+    void reserve(size_t n) {
+        data.reserve(n);
+    }
+
+    void addRange(std::span<const T> values) override {
+        data.reserve(data.size() + values.size());
+        data.insert(values.begin(), values.end());
+    }
+
+    void removeRange(std::span<const T> values) override {
+        for (const T& v : values) data.erase(v);
+    }
+};
+
+#endif //SETIMPL_H
@@ -0,0 +1,254 @@
+#ifndef SETSNAPSHOT_H
+#define SETSNAPSHOT_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "CompressedSetImpl.hpp"
+#include "../common/MappedFile.hpp"
+
+// Снимки множества на диске
+// Каждое представление пишется в формате, по которому можно искать прямо
+// в отображённой памяти: маленькое множество - отсортированный массив,
+// хеш-таблица - открытая адресация с линейным пробированием,
+// сжатое - массивы CompressedSetImpl как есть. Открытие - один mmap без
+// разбора содержимого, страницы подгружаются ОС при первом обращении.
+// Порядок байт - родной для машины, на другую архитектуру файлы не переносятся.
+
+enum class SnapshotKind : uint32_t {
+    SortedArray = 1,
+    HashTable = 2,
+    Compressed = 3,
+};
+
+namespace task_7 {
+    constexpr char kSnapshotMagic[8] = {'S', 'E', 'T', 'S', 'N', 'A', 'P', '1'};
+    using common::MappedFile;
+    using common::SnapshotWriter;
+    using common::alignUp;
+    constexpr size_t kSnapshotAlign = common::kSectionAlign;
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t kind;
+        uint32_t keySize;
+        uint32_t keySigned;
+        uint32_t reserved;
+        uint64_t count;      // Элементов в множестве
+        uint64_t params[4];  // Зависят от kind (ёмкость таблицы, число блоков...)
+    };
+    static_assert(sizeof(SnapshotHeader) == kSnapshotAlign);
+
+    // Хеш для таблицы на диске: должен совпадать между процессами,
+    // поэтому std::hash (зависящий от реализации) не подходит
+    inline uint64_t snapshotHash(uint64_t x) {
+        x ^= x >> 33; x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    template<PackableInteger T>
+    SnapshotHeader makeHeader(SnapshotKind kind, uint64_t count) {
+        SnapshotHeader header{};
+        std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+        header.kind = static_cast<uint32_t>(kind);
+        header.keySize = sizeof(T);
+        header.keySigned = std::is_signed_v<T>;
+        header.count = count;
+        return header;
+    }
+}
+
+// Множество, открытое из снимка: отсортированный массив или хеш-таблица,
+// лежащие прямо в отображённом файле. Только для чтения
+template<PackableInteger T>
+class MappedSetImpl : public SetImpl<T> {
+    std::shared_ptr<const task_7::MappedFile> file_;
+    SnapshotKind kind_;
+    size_t size_;
+    std::span<const T> slots_;  // Отсортированные элементы или ячейки таблицы
+    T empty_{};                 // Значение пустой ячейки таблицы
+
+public:
+    MappedSetImpl(std::shared_ptr<const task_7::MappedFile> file, SnapshotKind kind,
+                  size_t size, std::span<const T> slots, T empty)
+        : file_(std::move(file)), kind_(kind), size_(size), slots_(slots), empty_(empty) {}
+
+    void add(const T&) override {
+        throw std::logic_error("MappedSetImpl is read-only");
+    }
+
+    void remove(const T&) override {
+        throw std::logic_error("MappedSetImpl is read-only");
+    }
+
+    bool contains(const T& value) const override {
+        if (kind_ == SnapshotKind::SortedArray) {
+            return std::binary_search(slots_.begin(), slots_.end(), value);
+        }
+        if (value == empty_) return false;
+        // Не больше slots_.size() шагов: в испорченном файле может не быть
+        // ни одного пустого слота
+        size_t mask = slots_.size() - 1;
+        size_t i = task_7::snapshotHash(static_cast<uint64_t>(value)) & mask;
+        for (size_t n = 0; n < slots_.size(); ++n, i = (i + 1) & mask) {
+            if (slots_[i] == value) return true;
+            if (slots_[i] == empty_) return false;
+        }
+        return false;
+    }
+
+    std::vector<T> elements() const override {
+        if (kind_ == SnapshotKind::SortedArray) return std::vector<T>(slots_.begin(), slots_.end());
+        std::vector<T> result;
+        result.reserve(size_);
+        for (T v : slots_) {
+            if (v != empty_) result.push_back(v);
+        }
+        return result;
+    }
+
+    size_t size() const override {
+        return size_;
+    }
+
+    // Отображённые страницы, а не обязательно прочитанные с диска
+    size_t memoryUsage() const override {
+        return slots_.size_bytes();
+    }
+
+    bool isReadOnly() const override {
+        return true;
+    }
+
+    SnapshotKind kind() const {
+        return kind_;
+    }
+};
+
+namespace task_7 {
+    template<PackableInteger T>
+    void writeSortedArraySnapshot(const std::string& path, std::vector<T> values) {
+        std::sort(values.begin(), values.end());
+        SnapshotHeader header = makeHeader<T>(SnapshotKind::SortedArray, values.size());
+        SnapshotWriter out(path);
+        out.write(std::span<const SnapshotHeader>(&header, 1));
+        out.write(std::span<const T>(values));
+        out.finish();
+    }
+
+    // Таблица с заполнением не больше половины; пустые ячейки помечены значением,
+    // которого нет в множестве. Если такого нет (множество - весь диапазон T),
+    // пишем отсортированный массив
+    template<PackableInteger T>
+    void writeHashTableSnapshot(const std::string& path, const std::vector<T>& values) {
+        size_t capacity = std::bit_ceil(std::max<size_t>(16, 2 * values.size()));
+        size_t mask = capacity - 1;
+        std::vector<T> slots(capacity);
+        std::vector<bool> used(capacity);
+        auto find = [&](T v) {
+            size_t i = snapshotHash(static_cast<uint64_t>(v)) & mask;
+            while (used[i] && slots[i] != v) i = (i + 1) & mask;
+            return i;
+        };
+        for (T v : values) {
+            size_t i = find(v);
+            used[i] = true;
+            slots[i] = v;
+        }
+
+        T empty = std::numeric_limits<T>::min();
+        while (used[find(empty)]) {
+            if (empty == std::numeric_limits<T>::max()) {
+                writeSortedArraySnapshot(path, values);
+                return;
+            }
+            ++empty;
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            if (!used[i]) slots[i] = empty;
+        }
+
+        SnapshotHeader header = makeHeader<T>(SnapshotKind::HashTable, values.size());
+        header.params[0] = capacity;
+        header.params[1] = static_cast<uint64_t>(empty);
+        SnapshotWriter out(path);
+        out.write(std::span<const SnapshotHeader>(&header, 1));
+        out.write(std::span<const T>(slots));
+        out.finish();
+    }
+
+    template<PackableInteger T>
+    void writeCompressedSnapshot(const std::string& path, const CompressedSetImpl<T>& set) {
+        auto view = set.view();
+        SnapshotHeader header = makeHeader<T>(SnapshotKind::Compressed, view.size);
+        header.params[0] = view.blockFirst.size();
+        header.params[1] = view.bits.size();
+        SnapshotWriter out(path);
+        out.write(std::span<const SnapshotHeader>(&header, 1));
+        out.write(view.blockFirst);
+        out.write(view.blockOffset);
+        out.write(view.blockWidth);
+        out.write(view.bits);
+        out.finish();
+    }
+
+    // Открывает снимок; проверяются только заголовок и размеры секций,
+    // содержимое не читается
+    template<PackableInteger T>
+    std::unique_ptr<SetImpl<T>> openSnapshot(const std::string& path) {
+        auto file = std::make_shared<const MappedFile>(path);
+        if (file->size() < sizeof(SnapshotHeader)) throw std::runtime_error("corrupted snapshot: too short");
+        SnapshotHeader header;
+        std::memcpy(&header, file->data(), sizeof(header));
+        if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("not a set snapshot: " + path);
+        }
+        if (header.keySize != sizeof(T) || header.keySigned != std::is_signed_v<T>) {
+            throw std::runtime_error("snapshot key type mismatch: " + path);
+        }
+
+        size_t offset = sizeof(SnapshotHeader);
+        switch (static_cast<SnapshotKind>(header.kind)) {
+            case SnapshotKind::SortedArray: {
+                auto values = file->section<T>(offset, header.count);
+                return std::make_unique<MappedSetImpl<T>>(file, SnapshotKind::SortedArray, header.count, values, T{});
+            }
+            case SnapshotKind::HashTable: {
+                size_t capacity = header.params[0];
+                if (!std::has_single_bit(capacity) || capacity <= header.count) {
+                    throw std::runtime_error("corrupted snapshot: bad table capacity");
+                }
+                file->adviseRandom();
+                auto slots = file->section<T>(offset, capacity);
+                return std::make_unique<MappedSetImpl<T>>(file, SnapshotKind::HashTable, header.count, slots,
+                                                          static_cast<T>(header.params[1]));
+            }
+            case SnapshotKind::Compressed: {
+                using Key = typename CompressedSetImpl<T>::Key;
+                size_t blocks = header.params[0], words = header.params[1];
+                typename CompressedSetImpl<T>::View view;
+                view.size = header.count;
+                view.blockFirst = file->section<Key>(offset, blocks);
+                offset += alignUp(blocks * sizeof(Key));
+                view.blockOffset = file->section<uint64_t>(offset, blocks);
+                offset += alignUp(blocks * sizeof(uint64_t));
+                view.blockWidth = file->section<uint8_t>(offset, blocks);
+                offset += alignUp(blocks);
+                view.bits = file->section<uint64_t>(offset, words);
+                if (blocks != (view.size + CompressedSetImpl<T>::kBlockSize - 1) / CompressedSetImpl<T>::kBlockSize) {
+                    throw std::runtime_error("corrupted snapshot: bad block count");
+                }
+                return std::make_unique<CompressedSetImpl<T>>(view, file);
+            }
+        }
+        throw std::runtime_error("corrupted snapshot: unknown kind");
+    }
+}
+
+#endif //SETSNAPSHOT_H
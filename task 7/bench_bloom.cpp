@@ -0,0 +1,74 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "Set.hpp"
+
+// Бенчмарк фильтра Блума перед Set::contains на нагрузке из одних промахов.
+// Множество содержит чётные числа, запросы - нечётные, так что всякий запрос,
+// пропущенный фильтром к таблице, - ложное срабатывание.
+// Запуск: task_7_bench_bloom [число элементов] [число запросов]
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double measure(const Set<>& set, const std::vector<int>& probes) {
+        size_t hits = 0;
+        auto start = Clock::now();
+        for (int v : probes) hits += set.contains(v);
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (hits != 0) std::cerr << "unexpected hits: " << hits << '\n';
+        return ns / static_cast<double>(probes.size());
+    }
+
+    // Доля запросов, пропущенных фильтром к таблице
+    double falsePositiveRate(const Set<>& set, const std::vector<int>& probes) {
+        const BlockedBloomFilter* bloom = set.bloomFilter();
+        if (!bloom) return 1.0;
+        size_t passed = 0;
+        for (int v : probes) passed += bloom->mayContain(std::hash<int>{}(v));
+        return static_cast<double>(passed) / static_cast<double>(probes.size());
+    }
+
+    void report(const std::string& name, const Set<>& set, const std::vector<int>& probes, double nsPerOp, double baseline) {
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(10) << nsPerOp
+                  << std::setw(10) << baseline / nsPerOp
+                  << std::setw(14) << std::setprecision(3) << 100.0 * falsePositiveRate(set, probes)
+                  << std::setw(10) << set.memoryUsage() / (1 << 20) << '\n';
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t elements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+    size_t queries = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10'000'000;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, std::numeric_limits<int>::max() / 2);
+    std::vector<int> values(elements), probes(queries);
+    for (int& v : values) v = 2 * dist(rng);
+    for (int& v : probes) v = 2 * dist(rng) + 1;
+
+    std::cout << "miss-heavy contains(): " << elements << " elements, " << queries << " queries\n";
+    std::cout << std::left << std::setw(24) << "configuration" << std::right << std::setw(10) << "ns/op"
+              << std::setw(10) << "speedup" << std::setw(14) << "passed, %" << std::setw(10) << "MiB" << '\n';
+
+    auto set = Set<>::from_range(values);
+    double baseline = measure(set, probes);
+    report("hash", set, probes, baseline, baseline);
+    for (std::string fpp : {"0.05", "0.01", "0.001"}) {
+        set.enableBloomFilter(std::stod(fpp));
+        report("hash + bloom " + fpp, set, probes, measure(set, probes), baseline);
+    }
+
+    set.disableBloomFilter();
+    set.freeze();
+    double frozenBaseline = measure(set, probes);
+    report("frozen", set, probes, frozenBaseline, frozenBaseline);
+    set.enableBloomFilter(0.01);
+    report("frozen + bloom 0.01", set, probes, measure(set, probes), frozenBaseline);
+}
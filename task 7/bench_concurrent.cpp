@@ -0,0 +1,105 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "ConcurrentSetImpl.hpp"
+
+// Бенчмарк ConcurrentSetImpl: масштабирование contains по числу потоков
+// и проверка корректности при параллельных add/remove с расширением таблицы.
+// Для сравнения - HashSetImpl под одним std::mutex.
+// Запуск: task_7_bench_concurrent [число элементов] [операций на поток]
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // HashSetImpl под глобальной блокировкой - то, что пришлось бы делать без ConcurrentSetImpl
+    class LockedHashSet {
+        HashSetImpl<int> impl;
+        mutable std::mutex m;
+    public:
+        void add(int v) { std::lock_guard lock(m); impl.add(v); }
+        bool contains(int v) const { std::lock_guard lock(m); return impl.contains(v); }
+    };
+
+    // Запускает threads потоков, каждый делает ops проверок contains; возвращает млн. операций/с
+    template<class S>
+    double measureContains(const S& set, unsigned threads, size_t ops, int universe) {
+        std::vector<std::thread> pool;
+        std::vector<size_t> hits(threads);
+        auto start = Clock::now();
+        for (unsigned t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                std::mt19937 rng(t + 1);
+                std::uniform_int_distribution<int> dist(0, universe - 1);
+                size_t h = 0;
+                for (size_t i = 0; i < ops; ++i) h += set.contains(dist(rng));
+                hits[t] = h;
+            });
+        }
+        for (auto& th : pool) th.join();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return static_cast<double>(threads * ops) / seconds / 1e6;
+    }
+
+    // Параллельные вставки и удаления непересекающихся диапазонов; проверяет итог
+    bool checkConcurrentUpdates(unsigned threads, int perThread) {
+        ConcurrentSetImpl set;
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                int base = static_cast<int>(t) * perThread;
+                for (int i = 0; i < perThread; ++i) set.add(base + i);
+                for (int i = 0; i < perThread; i += 2) set.remove(base + i);
+            });
+        }
+        for (auto& th : pool) th.join();
+
+        size_t expected = threads * static_cast<size_t>(perThread / 2);
+        if (set.size() != expected || set.elements().size() != expected) return false;
+        for (int v = 0; v < static_cast<int>(threads) * perThread; ++v) {
+            if (set.contains(v) != (v % 2 == 1)) return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    int elements = argc > 1 ? std::atoi(argv[1]) : 1'000'000;
+    size_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2'000'000;
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Чётные числа: примерно половина проверок - промахи
+    ConcurrentSetImpl concurrent;
+    LockedHashSet locked;
+    for (int v = 0; v < 2 * elements; v += 2) {
+        concurrent.add(v);
+        locked.add(v);
+    }
+
+    std::cout << "contains() on " << elements << " elements, " << ops << " ops per thread\n";
+    std::cout << std::setw(8) << "threads" << std::setw(18) << "concurrent Mop/s"
+              << std::setw(10) << "speedup" << std::setw(14) << "locked Mop/s" << '\n';
+    std::vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    double base = 0;
+    for (unsigned threads : threadCounts) {
+        double c = measureContains(concurrent, threads, ops, 2 * elements);
+        double l = measureContains(locked, threads, ops, 2 * elements);
+        if (threads == 1) base = c;
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << threads << std::setw(18) << c
+                  << std::setw(10) << c / base << std::setw(14) << l << '\n';
+    }
+
+    unsigned writers = std::max(4u, maxThreads);
+    bool ok = checkConcurrentUpdates(writers, 200'000);
+    std::cout << "concurrent add/remove with resize on " << writers << " threads: "
+              << (ok ? "OK" : "FAILED") << '\n';
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "SetImpl.hpp"
+#include "CompressedSetImpl.hpp"
+#include "ConcurrentSetImpl.hpp"
+
+// Матрица бенчмарков реализаций SetImpl<int>: размеры x сценарии x распределения.
+// Печатает ns/op, находит размер, начиная с которого HashSetImpl устойчиво
+// быстрее VectorSetImpl (эмпирический kThreshold), и пишет всё в JSON,
+// чтобы результаты можно было сравнивать между коммитами.
+// Запуск: task_7_bench_matrix [файл.json] [максимальный размер]
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Векторная реализация квадратична на вставках, выше этого размера её не гоняем
+    constexpr size_t kVectorMaxSize = 4096;
+    // Сколько операций мерить в одном повторе и сколько повторов (берётся минимум)
+    constexpr size_t kOpsPerRun = 20'000;
+    constexpr int kRepeats = 3;
+
+    volatile size_t sink = 0;  // Не даёт компилятору выбросить результаты
+
+    struct ImplInfo {
+        std::string name;
+        std::function<std::unique_ptr<SetImpl<int>>(const std::vector<int>&)> make;
+        bool mutable_;
+        size_t maxSize;
+    };
+
+    std::vector<ImplInfo> implementations() {
+        auto fill = []<class I>(std::unique_ptr<I> impl, const std::vector<int>& values) {
+            impl->addRange(values);
+            return std::unique_ptr<SetImpl<int>>(std::move(impl));
+        };
+        return {
+            {"vector", [=](const auto& v) { return fill(std::make_unique<VectorSetImpl<int>>(), v); }, true, kVectorMaxSize},
+            {"hash", [=](const auto& v) { return fill(std::make_unique<HashSetImpl<int>>(), v); }, true, SIZE_MAX},
+            {"concurrent", [=](const auto& v) { return fill(std::make_unique<ConcurrentSetImpl>(), v); }, true, SIZE_MAX},
+            {"compressed", [](const auto& v) { return std::unique_ptr<SetImpl<int>>(std::make_unique<CompressedSetImpl<int>>(v)); }, false, SIZE_MAX},
+        };
+    }
+
+    // Распределения значений: плотное, равномерное по всему int, кластеры
+    std::vector<int> generate(const std::string& distribution, size_t n, std::mt19937& rng) {
+        std::vector<int> values(n);
+        if (distribution == "dense") {
+            std::iota(values.begin(), values.end(), 0);
+            std::shuffle(values.begin(), values.end(), rng);
+        } else if (distribution == "uniform") {
+            std::uniform_int_distribution<int> dist;
+            for (int& v : values) v = dist(rng);
+        } else {
+            // Отрезки по 64 подряд идущих числа в случайных местах
+            std::uniform_int_distribution<int> start(0, 1 << 30);
+            for (size_t i = 0; i < n; i += 64) {
+                int base = start(rng);
+                for (size_t j = i; j < std::min(n, i + 64); ++j) values[j] = base + static_cast<int>(j - i);
+            }
+        }
+        return values;
+    }
+
+    // Одна точка матрицы: готовит данные, затем мерит kOpsPerRun операций
+    // сценария kRepeats раз; возвращает лучшее время на операцию
+    double run(const ImplInfo& info, const std::string& mix, const std::string& distribution, size_t n) {
+        std::mt19937 rng(static_cast<unsigned>(n * 31 + mix.size()));
+        // Половина значений в множестве, половина - кандидаты на промах или вставку
+        auto pool = generate(distribution, 2 * n, rng);
+        std::vector<int> inside(pool.begin(), pool.begin() + static_cast<std::ptrdiff_t>(n));
+        std::vector<int> outside(pool.begin() + static_cast<std::ptrdiff_t>(n), pool.end());
+
+        double best = 1e300;
+        for (int rep = 0; rep < kRepeats; ++rep) {
+            auto set = info.make(inside);
+            size_t ops = 0, acc = 0;
+            auto start = Clock::now();
+            if (mix == "contains") {
+                // 50% попаданий
+                for (; ops < kOpsPerRun; ++ops) {
+                    const auto& src = ops % 2 ? inside : outside;
+                    acc += set->contains(src[ops % n]);
+                }
+            } else if (mix == "add_remove") {
+                // Размер держится около n: вставили новое, удалили старое
+                for (; ops < kOpsPerRun; ops += 2) {
+                    size_t i = (ops / 2) % n;
+                    set->add(outside[i]);
+                    set->remove(inside[i]);
+                    std::swap(inside[i], outside[i]);
+                }
+            } else if (mix == "mixed") {
+                // 80% contains, 10% add, 10% remove
+                for (; ops < kOpsPerRun; ++ops) {
+                    size_t i = ops % n;
+                    switch (ops % 10) {
+                        case 0: set->add(outside[i]); break;
+                        case 5: set->remove(outside[i]); break;
+                        default: acc += set->contains(ops % 2 ? inside[i] : outside[i]);
+                    }
+                }
+            } else {
+                // Объединение и пересечение - в пересчёте на элемент входа;
+                // второе множество пересекается с первым наполовину
+                auto half = pool.begin() + static_cast<std::ptrdiff_t>(n / 2);
+                auto other = info.make(std::vector<int>(half, half + static_cast<std::ptrdiff_t>(n)));
+                while (ops < kOpsPerRun) {
+                    if (mix == "union") {
+                        auto a = set->elements(), b = other->elements();
+                        a.insert(a.end(), b.begin(), b.end());
+                        acc += info.make(a)->size();
+                    } else if (auto* c = dynamic_cast<CompressedSetImpl<int>*>(set.get())) {
+                        acc += c->intersect(*dynamic_cast<CompressedSetImpl<int>*>(other.get())).size();
+                    } else {
+                        std::vector<int> common;
+                        for (int v : set->elements()) {
+                            if (other->contains(v)) common.push_back(v);
+                        }
+                        acc += info.make(common)->size();
+                    }
+                    ops += 2 * n;
+                }
+            }
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            sink = sink + acc;
+            best = std::min(best, ns / static_cast<double>(ops));
+        }
+        return best;
+    }
+
+    struct Point {
+        std::string impl, mix, distribution;
+        size_t size;
+        double nsPerOp;
+    };
+
+    // Наименьший размер, начиная с которого hash быстрее vector на всех больших размерах
+    // (0 - на самом большом измеренном размере vector ещё не хуже)
+    size_t crossover(const std::vector<Point>& points, const std::string& mix, const std::string& distribution) {
+        std::vector<std::pair<size_t, bool>> hashWins;  // размер -> hash быстрее
+        for (const auto& p : points) {
+            if (p.impl != "vector" || p.mix != mix || p.distribution != distribution) continue;
+            for (const auto& q : points) {
+                if (q.impl == "hash" && q.mix == mix && q.distribution == distribution && q.size == p.size) {
+                    hashWins.emplace_back(p.size, q.nsPerOp < p.nsPerOp);
+                }
+            }
+        }
+        size_t result = 0;
+        for (auto it = hashWins.rbegin(); it != hashWins.rend() && it->second; ++it) result = it->first;
+        return result;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string output = argc > 1 ? argv[1] : "set_bench_matrix.json";
+    size_t maxSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 65536;
+
+    // Размеры: мелкий шаг около текущего порога, дальше - удвоение
+    std::vector<size_t> sizes;
+    for (size_t n = 1; n <= std::min<size_t>(32, maxSize); ++n) {
+        if (n <= 16 || n % 4 == 0) sizes.push_back(n);
+    }
+    for (size_t n = 64; n <= maxSize; n *= 2) sizes.push_back(n);
+
+    const std::vector<std::string> mixes{"contains", "add_remove", "mixed", "union", "intersection"};
+    const std::vector<std::string> distributions{"dense", "uniform", "clustered"};
+    auto impls = implementations();
+
+    std::vector<Point> points;
+    for (const auto& mix : mixes) {
+        bool mutating = mix == "add_remove" || mix == "mixed";
+        for (const auto& distribution : distributions) {
+            std::cout << "\n== " << mix << " / " << distribution << " (ns/op) ==\n" << std::setw(8) << "size";
+            for (const auto& info : impls) std::cout << std::setw(12) << info.name;
+            std::cout << '\n';
+
+            for (size_t n : sizes) {
+                std::cout << std::setw(8) << n;
+                for (const auto& info : impls) {
+                    if (n > info.maxSize || (mutating && !info.mutable_)) {
+                        std::cout << std::setw(12) << "-";
+                        continue;
+                    }
+                    double ns = run(info, mix, distribution, n);
+                    points.push_back({info.name, mix, distribution, n, ns});
+                    std::cout << std::setw(12) << std::fixed << std::setprecision(1) << ns;
+                }
+                std::cout << '\n';
+            }
+        }
+    }
+
+    std::cout << "\nvector -> hash crossover (current kThreshold = " << SetTraits<int>::kThreshold << "):\n";
+    std::ofstream json(output);
+    json << "{\n  \"max_size\": " << maxSize << ",\n  \"threshold\": " << SetTraits<int>::kThreshold
+         << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < points.size(); ++i) {
+        const auto& p = points[i];
+        json << "    {\"impl\": \"" << p.impl << "\", \"mix\": \"" << p.mix << "\", \"distribution\": \""
+             << p.distribution << "\", \"size\": " << p.size << ", \"ns_per_op\": " << p.nsPerOp << '}'
+             << (i + 1 < points.size() ? ",\n" : "\n");
+    }
+    json << "  ],\n  \"crossovers\": [\n";
+    bool first = true;
+    for (const auto& mix : mixes) {
+        for (const auto& distribution : distributions) {
+            size_t at = crossover(points, mix, distribution);
+            std::cout << "  " << std::left << std::setw(28) << (mix + " / " + distribution) << std::right
+                      << (at ? "hash wins from size " + std::to_string(at) : std::string("no stable crossover in measured range")) << '\n';
+            json << (first ? "" : ",\n") << "    {\"mix\": \"" << mix << "\", \"distribution\": \"" << distribution
+                 << "\", \"hash_wins_from\": " << at << '}';
+            first = false;
+        }
+    }
+    json << "\n  ]\n}\n";
+    std::cout << "results written to " << output << '\n';
+}
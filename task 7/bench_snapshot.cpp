@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+#include "Set.hpp"
+
+// Холодный старт множества: построение заново через Set::from_range
+// против Set::open снимка (хеш-таблица и сжатое представление).
+// Запуск: task_7_bench_snapshot [число элементов]
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Время первых запросов к открытому снимку: в них входят подкачки страниц
+    double probeMs(const Set<>& set, const std::vector<int>& probes, size_t& hits) {
+        auto start = Clock::now();
+        for (int v : probes) hits += set.contains(v);
+        return msSince(start);
+    }
+
+    void report(const std::string& name, double ms) {
+        std::cout << std::left << std::setw(40) << name << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(12) << ms << " ms\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t elements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    auto dir = std::filesystem::temp_directory_path();
+    std::string hashPath = (dir / "task_7_hash.snap").string();
+    std::string frozenPath = (dir / "task_7_frozen.snap").string();
+
+    std::mt19937 rng(7);
+    std::vector<int> values(elements), probes(1000);
+    for (int& v : values) v = static_cast<int>(rng() >> 1);
+    for (int& v : probes) v = values[rng() % values.size()];
+
+    std::cout << "cold start of a " << elements << "-element set\n";
+    auto start = Clock::now();
+    auto built = Set<>::from_range(values);
+    report("rebuild with Set::from_range", msSince(start));
+
+    start = Clock::now();
+    built.save(hashPath);
+    report("save hash table snapshot", msSince(start));
+    built.freeze();
+    start = Clock::now();
+    built.save(frozenPath);
+    report("save compressed snapshot", msSince(start));
+
+    size_t hits = 0;
+    for (const auto& [name, path] : {std::pair{"hash table", hashPath}, std::pair{"compressed", frozenPath}}) {
+        start = Clock::now();
+        auto opened = Set<>::open(path);
+        report(std::string("open ") + name + " snapshot", msSince(start));
+        report("  first 1000 contains (page faults)", probeMs(opened, probes, hits));
+        report("  next 1000 contains", probeMs(opened, probes, hits));
+        std::cout << "  file size: " << std::filesystem::file_size(path) / (1 << 20) << " MiB\n";
+
+        // Сохранение поверх файла, из которого множество открыто: новый снимок
+        // пишется рядом и заменяет старый, отображение дочитывает старый
+        start = Clock::now();
+        opened.save(path);
+        report("  save over its own file", msSince(start));
+        auto resaved = Set<>::open(path);
+        hits += resaved.size() == opened.size() && !std::filesystem::exists(path + ".tmp");
+        for (int v : probes) hits += resaved.contains(v) && opened.contains(v);
+    }
+
+    std::filesystem::remove(hashPath);
+    std::filesystem::remove(frozenPath);
+    bool ok = hits == 2 * (2 * probes.size() + 1 + probes.size());
+    std::cout << (ok ? "all probes found" : "MISSING PROBES") << '\n';
+    return ok ? 0 : 1;
+}
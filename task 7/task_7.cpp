@@ -1,169 +1,11 @@
-#include <iostream>
-#include <vector>
-#include <unordered_set>
-#include <memory>
-#include <algorithm>
-
 #define DEBUGPRINT
 
-// Базовый интерфейс для реализации множества
-// Определяет основные операции работы с множеством
-class SetImpl {
-public:
-    virtual ~SetImpl() = default;
-    
-    // Добавляет элемент в множество (если его там нет)
-    virtual void add(int value) = 0;
-    
-    // Удаляет элемент из множества
-    virtual void remove(int value) = 0;
-    
-    // Проверяет наличие элемента в множестве
-    virtual bool contains(int value) const = 0;
-    
-    // Возвращает все элементы множества в виде вектора
-    virtual std::vector<int> elements() const = 0;
-};
-
-// Реализация множества на основе вектора
-// Оптимальна для небольших множеств (до 10 элементов)
-class VectorSetImpl : public SetImpl {
-    std::vector<int> data;  // Хранение элементов в векторе
-    
-public:
-    void add(int value) override {
-        if (!contains(value)) {
-            data.push_back(value);  // Добавляем только уникальные элементы
-        }
-    }
-    
-    void remove(int value) override {
-        // Удаляем все вхождения элемента (хотя в множестве их должно быть не более одного)
-        data.erase(std::remove(data.begin(), data.end(), value), data.end());
-    }
-    
-    bool contains(int value) const override {
-        return std::find(data.begin(), data.end(), value) != data.end();
-    }
-    
-    std::vector<int> elements() const override {
-        return data;  // Возвращаем копию вектора
-    }
-};
-
-// Реализация множества на основе хеш-таблицы
-// Оптимальна для больших множеств (более 10 элементов)
-class HashSetImpl : public SetImpl {
-    std::unordered_set<int> data;  // Хранение элементов в хеш-таблице
-    
-public:
-    void add(int value) override {
-        data.insert(value);  // insert автоматически проверяет уникальность
-    }
-    
-    void remove(int value) override {
-        data.erase(value);
-    }
-    
-    bool contains(int value) const override {
-        return data.contains(value);
-    }
-    
-    std::vector<int> elements() const override {
-        return std::vector<int>(data.begin(), data.end());
-    }
-};
-
-
-// Абстракция множества с автоматическим переключением реализаций
-// Переключается между векторной и хеш-табличной реализацией
-// при достижении порогового размера (kThreshold)
-class Set {
-    std::unique_ptr<SetImpl> impl;  // Текущая реализация
-    
-    // Пороговое значение для переключения реализаций
-    static constexpr size_t kThreshold = 10;
-    
-    // Переключает реализацию при необходимости
-    // На основе текущего размера множества
-    void SwitchImpl() {
-        size_t sz = impl->elements().size();
-        bool usingHashNow = dynamic_cast<HashSetImpl*>(impl.get()) != nullptr;
-
-#ifdef DEBUGPRINT
-        std::string to = usingHashNow ? "vector" : "hash";
-        std::cout << "SWITCHING TO " << to << " implementation with size: " << sz << std::endl;
-#endif
-
-        // Переключаемся на хеш-таблицу, если размер превысил порог и сейчас вектор
-        if (!usingHashNow && sz > kThreshold) {
-            auto elems = impl->elements();
-            impl = std::make_unique<HashSetImpl>();
-            for (int v : elems) impl->add(v);
-        } 
-        // Возвращаемся к вектору, если размер уменьшился до порога и сейчас хеш-таблица
-        else if (usingHashNow && sz <= kThreshold) {
-            auto elems = impl->elements();
-            impl = std::make_unique<VectorSetImpl>();
-            for (int v : elems) impl->add(v);
-        }
-    }
-
-public:
-    // По умолчанию используем векторную реализацию
-    Set() : impl(std::make_unique<VectorSetImpl>()) {}
-
-    void add(int value) {
-        impl->add(value);
-        // Проверяем необходимость переключения после добавления
-        if (impl->elements().size() == kThreshold + 1) {
-            SwitchImpl();
-        }
-    }
-    
-    void remove(int value) {
-        impl->remove(value);
-        // Проверяем необходимость переключения после удаления
-        if (impl->elements().size() == kThreshold) {
-            SwitchImpl();
-        }
-    }
-    
-    bool contains(int value) const {
-        return impl->contains(value);
-    }
-    
-    // Возвращает объединение двух множеств
-    // Создает новое множество, содержащее все элементы из обоих множеств
-    Set setUnion(const Set& other) const {
-        Set result;
-        for (int v : impl->elements()) result.add(v);
-        for (int v : other.impl->elements()) result.add(v);
-        return result;
-    }
-    
-    // Возвращает пересечение двух множеств
-    // Создает новое множество, содержащее только общие элементы
-    Set setIntersection(const Set& other) const {
-        Set result;
-        for (int v : impl->elements()) {
-            if (other.contains(v)) {
-                result.add(v);
-            }
-        }
-        return result;
-    }
-    
-    // Выводит содержимое множества в удобочитаемом формате
-    void print() const {
-        auto elems = impl->elements();
-        std::cout << "{";
-        for (size_t i = 0; i < elems.size(); ++i) {
-            std::cout << elems[i] << (i+1 < elems.size() ? ", " : "");
-        }
-        std::cout << "}\n";
-    }
-};
+#include <iostream>
+#include <cstdint>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include "Set.hpp"
 
 int main() {
     Set a;
@@ -183,4 +25,44 @@ int main() {
 
     std::cout << "Union: "; u.print();
     std::cout << "Intersection: "; inter.print();
+
+    // Пакетная загрузка: реализация выбирается сразу по итоговому размеру
+    std::vector<int> big(1'000'000);
+    std::iota(big.begin(), big.end(), 0);
+    auto c = Set<>::from_sorted_range(big);
+    c.remove_range(std::span<const int>(big).subspan(5));
+    std::cout << "Bulk: "; c.print();
+
+    // Сжатое неизменяемое представление для больших статичных множеств
+    std::vector<int> sparse(big.size());
+    for (size_t i = 0; i < sparse.size(); ++i) sparse[i] = static_cast<int>(i * 37);
+    auto d = Set<>::from_range(sparse);
+    size_t hashBytes = d.memoryUsage();
+    d.freeze();
+    std::cout << "Frozen: " << hashBytes << " -> " << d.memoryUsage() << " bytes, contains(370) = "
+              << d.contains(370) << ", contains(371) = " << d.contains(371) << '\n';
+
+    auto e = Set<>::from_range(big);
+    e.freeze();
+    std::cout << "Frozen intersection size: " << d.setIntersection(e).size() << '\n';
+
+    // То же адаптивное множество для других типов ключей
+    Set<std::string> names;
+    for (const char* n : {"alice", "bob", "carol", "alice"}) names.add(n);
+    std::cout << "Strings: "; names.print();
+
+    std::vector<int64_t> ids{1LL << 40, 3LL << 40, 1LL << 40, -(1LL << 50)};
+    auto idSet = Set<int64_t>::from_range(ids);
+    idSet.freeze();
+    std::cout << "Frozen int64: contains(2^40) = " << idSet.contains(1LL << 40) << ", ";
+    idSet.print();
+
+    // Снимок на диске: открывается через mmap без повторного построения
+    auto snapshot = (std::filesystem::temp_directory_path() / "task_7_demo.snap").string();
+    d.save(snapshot);
+    auto reopened = Set<>::open(snapshot);
+    std::cout << "Reopened: size = " << reopened.size() << ", contains(370) = " << reopened.contains(370) << '\n';
+    reopened.add(371);  // Первое изменение переносит множество в память
+    std::cout << "After add: size = " << reopened.size() << '\n';
+    std::filesystem::remove(snapshot);
 }
\ No newline at end of file
@@ -0,0 +1,245 @@
+#ifndef BATCHEVALUATOR_H
+#define BATCHEVALUATOR_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "Expression.hpp"
+#include "VariableLayout.hpp"
+#include "RangeAnalysis.hpp"
+
+//------------------------------
+// Пакетное вычисление одного выражения по столбцам.
+// На вход - по столбцу значений на каждую переменную раскладки, на выходе -
+// столбец результатов и флаг ошибки на строку. Узлы выражения выполняются
+// ядрами над блоками по kBlock строк: короткие циклы без ветвлений
+// с известным числом итераций компилятор разворачивает в SIMD
+//------------------------------
+class BatchEvaluator {
+public:
+    static constexpr size_t kBlock = 256;
+
+private:
+    // Откуда ядро берёт операнд: столбец переменной, размноженная константа
+    // или временный блок с результатом другого узла
+    struct Operand {
+        enum Source : uint8_t { Column, Constant, Temp } source;
+        uint32_t index;
+    };
+
+    struct Step {
+        ExprKind op;
+        Operand lhs, rhs;
+        uint32_t out;  // Номер временного блока
+        bool unchecked;  // Деление, безопасность которого доказал RangeAnalysis
+        bool masked;     // Непроверяемое деление, операнды которого могли пострадать от ошибки
+    };
+
+    VariableLayout layout_;
+    std::vector<Step> steps;
+    std::vector<int> constants;  // По kBlock копий каждой константы
+    Operand result{};
+    uint32_t temps = 0;
+
+    // Сборка плана: обход в глубину, общий (разделяемый) узел считается
+    // один раз; временный блок освобождается после последнего чтения
+    struct Planner {
+        BatchEvaluator& self;
+        std::unordered_map<const Expression*, Operand> done;
+        std::unordered_map<const Expression*, size_t> usesLeft;
+        std::unordered_map<int, uint32_t> constantIndex;
+        std::vector<uint32_t> freeTemps;
+        std::unordered_map<const Expression*, bool> mayFault;  // Есть ли в поддереве проверяемое деление
+        const RangeAnalysis* ranges;
+
+        void countUses(const Expression& e) {
+            if (usesLeft[&e]++ > 0 || e.kind() == ExprKind::Constant || e.kind() == ExprKind::Variable) return;
+            auto& bin = static_cast<const BinaryOp&>(e);
+            countUses(*bin.getLeft());
+            countUses(*bin.getRight());
+        }
+
+        void release(const Expression& e, Operand op) {
+            if (op.source == Operand::Temp && --usesLeft[&e] == 0) freeTemps.push_back(op.index);
+        }
+
+        Operand plan(const Expression& e) {
+            if (auto it = done.find(&e); it != done.end()) return it->second;
+            Operand op{};
+            if (e.kind() == ExprKind::Constant) {
+                int value = static_cast<const Constant&>(e).getValue();
+                auto [it, inserted] = constantIndex.try_emplace(value, static_cast<uint32_t>(constantIndex.size()));
+                if (inserted) self.constants.insert(self.constants.end(), kBlock, value);
+                op = {Operand::Constant, it->second};
+            } else if (e.kind() == ExprKind::Variable) {
+                // Здесь же обнаруживается переменная, которой нет в раскладке
+                op = {Operand::Column, static_cast<uint32_t>(self.layout_.slotOf(static_cast<const Variable&>(e).getName()))};
+            } else {
+                auto& bin = static_cast<const BinaryOp&>(e);
+                Operand l = plan(*bin.getLeft()), r = plan(*bin.getRight());
+                // Выход выделяется до освобождения входов: ядра требуют,
+                // чтобы выходной блок не совпадал с входным
+                uint32_t out;
+                if (freeTemps.empty()) {
+                    out = self.temps++;
+                } else {
+                    out = freeTemps.back();
+                    freeTemps.pop_back();
+                }
+                release(*bin.getLeft(), l);
+                release(*bin.getRight(), r);
+                bool unchecked = e.kind() == ExprKind::IntegerDivide && ranges && ranges->divisionIsSafe(e);
+                // Строка с ошибкой не останавливается: проверяемое деление пишет
+                // в неё a / 1, и значение может выйти за отрезок из анализа.
+                // Такие строки уже помечены, и делитель в них подменяется единицей
+                bool operandsMayFault = mayFault[bin.getLeft().get()] || mayFault[bin.getRight().get()];
+                mayFault[&e] = operandsMayFault || (e.kind() == ExprKind::IntegerDivide && !unchecked);
+                self.steps.push_back({e.kind(), l, r, out, unchecked, unchecked && operandsMayFault});
+                op = {Operand::Temp, out};
+            }
+            done.emplace(&e, op);
+            return op;
+        }
+    };
+
+    // Ядра. Арифметика в unsigned: переполнение заворачивается, как в железе,
+    // а не является UB. Указатели не пересекаются: выход - свой временный блок
+    static void add(const int* __restrict a, const int* __restrict b, int* __restrict out) {
+        for (size_t i = 0; i < kBlock; ++i) out[i] = static_cast<int>(static_cast<unsigned>(a[i]) + static_cast<unsigned>(b[i]));
+    }
+
+    static void subtract(const int* __restrict a, const int* __restrict b, int* __restrict out) {
+        for (size_t i = 0; i < kBlock; ++i) out[i] = static_cast<int>(static_cast<unsigned>(a[i]) - static_cast<unsigned>(b[i]));
+    }
+
+    static void multiply(const int* __restrict a, const int* __restrict b, int* __restrict out) {
+        for (size_t i = 0; i < kBlock; ++i) out[i] = static_cast<int>(static_cast<unsigned>(a[i]) * static_cast<unsigned>(b[i]));
+    }
+
+    // Делитель 0 (и пара INT_MIN / -1) подменяется единицей через select,
+    // строка с нулём помечается в errors. Само целочисленное деление в x86
+    // векторной инструкции не имеет, но ветвлений в цикле нет
+    static void divide(const int* __restrict a, const int* __restrict b, int* __restrict out, uint8_t* __restrict errors) {
+        for (size_t i = 0; i < kBlock; ++i) {
+            int x = a[i], y = b[i];
+            bool zero = y == 0;
+            bool overflow = (x == INT_MIN) & (y == -1);
+            int safe = (zero | overflow) ? 1 : y;
+            out[i] = x / safe;
+            errors[i] |= static_cast<uint8_t>(zero);
+        }
+    }
+
+    // Делитель доказанно не ноль и пары INT_MIN / -1 нет: ни select, ни флагов
+    static void divideUnchecked(const int* __restrict a, const int* __restrict b, int* __restrict out) {
+        for (size_t i = 0; i < kBlock; ++i) out[i] = a[i] / b[i];
+    }
+
+    // То же, но доказательство верно только для строк без ошибок: в уже
+    // помеченных делитель подменяется единицей, значение там не определено
+    static void divideMasked(const int* __restrict a, const int* __restrict b, int* __restrict out, const uint8_t* __restrict errors) {
+        for (size_t i = 0; i < kBlock; ++i) out[i] = a[i] / (errors[i] ? 1 : b[i]);
+    }
+
+    void plan(const Expression& e, const RangeAnalysis* ranges) {
+        Planner planner{*this, {}, {}, {}, {}, {}, ranges};
+        planner.countUses(e);
+        result = planner.plan(e);
+    }
+
+public:
+    // Связывание с раскладкой: бросает std::logic_error, если переменной в ней нет
+    BatchEvaluator(const Expression& e, VariableLayout layout) : layout_(std::move(layout)) {
+        plan(e, nullptr);
+    }
+
+    // С интервальным анализом того же выражения: доказанно безопасные деления
+    // идут через ядро без select и флагов ошибок. Строки должны соблюдать
+    // границы, с которыми проводился анализ
+    BatchEvaluator(const Expression& e, VariableLayout layout, const RangeAnalysis& ranges) : layout_(std::move(layout)) {
+        plan(e, &ranges);
+    }
+
+    explicit BatchEvaluator(const Expression& e) : BatchEvaluator(e, VariableLayout::of(e)) {}
+
+    const VariableLayout& layout() const { return layout_; }
+
+    // columns[slot] - значения переменной слота, все столбцы длиной out.size().
+    // errors[i] становится 1, если при вычислении строки i было деление на ноль
+    // (значение out[i] тогда не определено). Возвращает число таких строк
+    size_t evaluate(std::span<const std::span<const int>> columns, std::span<int> out, std::span<uint8_t> errors) const {
+        const size_t rows = out.size();
+        if (columns.size() < layout_.size() || errors.size() < rows) {
+            throw std::logic_error("Batch evaluation: wrong number of columns or rows");
+        }
+        for (size_t slot = 0; slot < layout_.size(); ++slot) {
+            if (columns[slot].size() < rows) throw std::logic_error("Batch evaluation: column is too short");
+        }
+
+        // Хвост, не кратный kBlock, копируется в дополненные блоки
+        std::vector<int> scratch(temps * kBlock);
+        std::vector<int> tailColumns(rows % kBlock ? layout_.size() * kBlock : 0);
+        uint8_t blockErrors[kBlock];
+
+        size_t failed = 0;
+        for (size_t row = 0; row < rows; row += kBlock) {
+            const size_t n = std::min(kBlock, rows - row);
+            const bool tail = n < kBlock;
+            if (tail) {
+                for (size_t slot = 0; slot < layout_.size(); ++slot) {
+                    std::copy_n(columns[slot].data() + row, n, tailColumns.data() + slot * kBlock);
+                    // Дополнение - копия первой строки блока: она в границах
+                    // анализа, так что и непроверяемое деление на ней безопасно
+                    std::fill_n(tailColumns.data() + slot * kBlock + n, kBlock - n, columns[slot][row]);
+                }
+            }
+            auto source = [&](Operand op) -> const int* {
+                switch (op.source) {
+                    case Operand::Column:
+                        return tail ? tailColumns.data() + op.index * kBlock : columns[op.index].data() + row;
+                    case Operand::Constant:
+                        return constants.data() + op.index * kBlock;
+                    default:
+                        return scratch.data() + op.index * kBlock;
+                }
+            };
+
+            std::fill_n(blockErrors, kBlock, 0);
+            for (const Step& step : steps) {
+                const int* a = source(step.lhs);
+                const int* b = source(step.rhs);
+                int* dst = scratch.data() + step.out * kBlock;
+                switch (step.op) {
+                    case ExprKind::Add: add(a, b, dst); break;
+                    case ExprKind::Subtract: subtract(a, b, dst); break;
+                    case ExprKind::Multiply: multiply(a, b, dst); break;
+                    default:
+                        if (step.masked) {
+                            divideMasked(a, b, dst, blockErrors);
+                        } else if (step.unchecked) {
+                            divideUnchecked(a, b, dst);
+                        } else {
+                            divide(a, b, dst, blockErrors);
+                        }
+                        break;
+                }
+            }
+
+            std::copy_n(source(result), n, out.data() + row);
+            for (size_t i = 0; i < n; ++i) {
+                errors[row + i] = blockErrors[i];
+                failed += blockErrors[i];
+            }
+        }
+        return failed;
+    }
+
+    // Число вызовов ядер на блок и временных блоков плана
+    size_t kernelCount() const { return steps.size(); }
+    size_t temporaries() const { return temps; }
+};
+
+#endif //BATCHEVALUATOR_H
@@ -0,0 +1,292 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Expression.hpp"
+#include "VariableLayout.hpp"
+#include "RangeAnalysis.hpp"
+
+//------------------------------
+// Компиляция AST в линейный байткод и стековая виртуальная машина
+//------------------------------
+
+// Команды VM. Вершина стека держится в "аккумуляторе" (регистре),
+// поэтому бинарная операция читает из памяти только левый операнд.
+// Формы *Const и *Var берут правый операнд прямо из аргумента команды:
+// для типичного "x + 1" это одна команда вместо трёх
+enum class OpCode : uint8_t {
+    PushConst,  // push acc; acc = arg
+    LoadVar,    // push acc; acc = slots[arg]
+    Add,        // acc = pop() + acc
+    Sub,
+    Mul,
+    Div,
+    AddConst,   // acc = acc + arg
+    SubConst,
+    MulConst,
+    DivConst,   // arg != 0 и arg != -1 гарантирует компилятор
+    AddVar,     // acc = acc + slots[arg]
+    SubVar,
+    MulVar,
+    DivVar,
+    StoreTemp,  // temps[arg] = acc - значение общего (разделяемого) узла
+    LoadTemp,   // push acc; acc = temps[arg]
+    DivUnchecked,     // acc = pop() / acc без проверок: RangeAnalysis доказал,
+    DivVarUnchecked,  // что делитель не ноль и INT_MIN // -1 невозможно
+};
+
+struct Instruction {
+    OpCode op;
+    int32_t arg;
+};
+
+// Скомпилированное (связанное) выражение: команды плюс раскладка контекста.
+// Переменные уже разрешены в номера слотов, run принимает значения
+// в порядке layout()
+class BytecodeProgram {
+    std::vector<Instruction> code;
+    VariableLayout layout_;
+    size_t maxStack = 0;
+    size_t temps = 0;  // Ячейки для значений общих узлов DAG
+
+    friend class BytecodeCompiler;
+
+    // Глубина стека, до которой хватает буфера на стеке вызова
+    static constexpr size_t kInlineStack = 64;
+
+    [[noreturn]] static void divisionByZero() {
+        throw std::logic_error("Division by zero!");
+    }
+
+    // Арифметика - ValueTraits<int>, как у дерева: +, -, * заворачиваются,
+    // INT_MIN // -1 == INT_MIN.
+    // Throw = false: деление на ноль не бросает исключение, а взводит *failed
+    template<bool Throw = true>
+    int execute(const int* slots, int* stack, int* temp, bool* failed = nullptr) const {
+        using T = ValueTraits<int>;
+        int acc = 0;
+        int* sp = stack;
+        for (const Instruction& in : code) {
+            switch (in.op) {
+                case OpCode::PushConst: *sp++ = acc; acc = in.arg; break;
+                case OpCode::LoadVar:   *sp++ = acc; acc = slots[in.arg]; break;
+                case OpCode::Add: acc = T::add(*--sp, acc); break;
+                case OpCode::Sub: acc = T::subtract(*--sp, acc); break;
+                case OpCode::Mul: acc = T::multiply(*--sp, acc); break;
+                case OpCode::Div:
+                    if (acc == 0) {
+                        if constexpr (Throw) divisionByZero();
+                        *failed = true;
+                        return 0;
+                    }
+                    acc = T::divide(*--sp, acc);
+                    break;
+                case OpCode::AddConst: acc = T::add(acc, in.arg); break;
+                case OpCode::SubConst: acc = T::subtract(acc, in.arg); break;
+                case OpCode::MulConst: acc = T::multiply(acc, in.arg); break;
+                case OpCode::DivConst: acc /= in.arg; break;
+                case OpCode::AddVar: acc = T::add(acc, slots[in.arg]); break;
+                case OpCode::SubVar: acc = T::subtract(acc, slots[in.arg]); break;
+                case OpCode::MulVar: acc = T::multiply(acc, slots[in.arg]); break;
+                case OpCode::DivVar:
+                    if (slots[in.arg] == 0) {
+                        if constexpr (Throw) divisionByZero();
+                        *failed = true;
+                        return 0;
+                    }
+                    acc = T::divide(acc, slots[in.arg]);
+                    break;
+                case OpCode::StoreTemp: temp[in.arg] = acc; break;
+                case OpCode::LoadTemp:  *sp++ = acc; acc = temp[in.arg]; break;
+                case OpCode::DivUnchecked: acc = *--sp / acc; break;
+                case OpCode::DivVarUnchecked: acc /= slots[in.arg]; break;
+            }
+        }
+        return acc;
+    }
+
+public:
+    // Вычисление по значениям переменных, разложенным по слотам
+    int run(std::span<const int> slots) const {
+        if (slots.size() < layout_.size()) {
+            throw std::logic_error("Context has fewer slots than the layout");
+        }
+        if (maxStack + temps <= kInlineStack) {
+            int stack[kInlineStack];
+            return execute(slots.data(), stack + temps, stack);
+        }
+        std::vector<int> stack(maxStack + temps);
+        return execute(slots.data(), stack.data() + temps, stack.data());
+    }
+
+    // Вариант без исключений и без аллокаций для горячих циклов: буфер стека -
+    // scratch вызывающего (растёт только при первом использовании).
+    // Возвращает false при делении на ноль; размер slots не проверяется
+    bool tryRun(std::span<const int> slots, std::vector<int>& scratch, int& result) const {
+        if (scratch.size() < maxStack + temps) scratch.resize(maxStack + temps);
+        bool failed = false;
+        result = execute<false>(slots.data(), scratch.data() + temps, scratch.data(), &failed);
+        return !failed;
+    }
+
+    // Совместимый с Expression::evaluate вариант: раскладывает словарь по слотам
+    // (в нём должны быть все переменные раскладки)
+    int evaluate(const std::map<std::string, int>& vars) const {
+        return run(layout_.makeContext(vars));
+    }
+
+    const VariableLayout& layout() const { return layout_; }
+
+    // Число команд
+    size_t size() const { return code.size(); }
+
+    // Текстовый листинг (для отладки)
+    void disassemble(std::ostream& os) const {
+        static const char* names[] = {
+            "push", "load", "add", "sub", "mul", "div",
+            "add.c", "sub.c", "mul.c", "div.c", "add.v", "sub.v", "mul.v", "div.v",
+            "store.t", "load.t", "div.u", "div.v.u",
+        };
+        for (const Instruction& in : code) {
+            auto op = static_cast<size_t>(in.op);
+            os << names[op];
+            if (in.op == OpCode::PushConst || (in.op >= OpCode::AddConst && in.op <= OpCode::DivConst)) {
+                os << ' ' << in.arg;
+            } else if (in.op == OpCode::LoadVar || (in.op >= OpCode::AddVar && in.op <= OpCode::DivVar) || in.op == OpCode::DivVarUnchecked) {
+                os << ' ' << layout_.variables()[static_cast<size_t>(in.arg)];
+            } else if (in.op == OpCode::StoreTemp || in.op == OpCode::LoadTemp) {
+                os << ' ' << in.arg;
+            }
+            os << '\n';
+        }
+    }
+};
+
+// Компилятор AST -> байткод: обход в глубину, левый операнд раньше правого.
+// Компиляция и есть связывание: каждая переменная разрешается в слот
+// раскладки один раз, и неизвестная переменная - ошибка уже здесь.
+// Составной узел, на который ссылаются несколько родителей (DAG после
+// хеширования в ExpressionFactory), вычисляется один раз и сохраняется в temps
+class BytecodeCompiler {
+    BytecodeProgram program;
+    size_t depth = 0;
+    std::unordered_map<const Expression*, size_t> parents;  // Число ссылок на узел
+    std::unordered_map<const Expression*, int32_t> tempOf;   // Уже вычисленные общие узлы
+    const RangeAnalysis* ranges = nullptr;                   // Доказанно безопасные деления
+
+    void countParents(const Expression& e) {
+        if (parents[&e]++ > 0 || e.kind() == ExprKind::Constant || e.kind() == ExprKind::Variable) return;
+        auto& bin = static_cast<const BinaryOp&>(e);
+        countParents(*bin.getLeft());
+        countParents(*bin.getRight());
+    }
+
+    explicit BytecodeCompiler(VariableLayout layout) {
+        program.layout_ = std::move(layout);
+    }
+
+    int32_t slot(const std::string& name) const {
+        return static_cast<int32_t>(program.layout_.slotOf(name));
+    }
+
+    void push(OpCode op, int32_t arg) {
+        program.code.push_back({op, arg});
+        program.maxStack = std::max(program.maxStack, ++depth);
+    }
+
+    void emit(const Expression& e) {
+        switch (e.kind()) {
+            case ExprKind::Constant:
+                push(OpCode::PushConst, static_cast<const Constant&>(e).getValue());
+                return;
+            case ExprKind::Variable:
+                push(OpCode::LoadVar, slot(static_cast<const Variable&>(e).getName()));
+                return;
+            default:
+                break;
+        }
+
+        const bool shared = parents[&e] > 1;
+        if (shared) {
+            if (auto it = tempOf.find(&e); it != tempOf.end()) {
+                push(OpCode::LoadTemp, it->second);
+                return;
+            }
+        }
+
+        auto& bin = static_cast<const BinaryOp&>(e);
+        int base = 0;  // Смещение от общей формы к *Const / *Var
+        switch (e.kind()) {
+            case ExprKind::Add: base = 0; break;
+            case ExprKind::Subtract: base = 1; break;
+            case ExprKind::Multiply: base = 2; break;
+            default: base = 3; break;
+        }
+        auto op = [base](OpCode first) { return static_cast<OpCode>(static_cast<int>(first) + base); };
+
+        emit(*bin.getLeft());
+        const Expression& rhs = *bin.getRight();
+        const bool safe = base == 3 && ranges && ranges->divisionIsSafe(e);
+        int constant = rhs.kind() == ExprKind::Constant ? static_cast<const Constant&>(rhs).getValue() : 0;
+        if (rhs.kind() == ExprKind::Constant && !(base == 3 && (constant == 0 || (constant == -1 && !safe)))) {
+            // Деление на константный ноль (бросает) и на -1 (INT_MIN // -1,
+            // если анализ его не исключил) оставляем общей форме
+            program.code.push_back({op(OpCode::AddConst), constant});
+        } else if (rhs.kind() == ExprKind::Variable) {
+            int32_t s = slot(static_cast<const Variable&>(rhs).getName());
+            program.code.push_back({safe ? OpCode::DivVarUnchecked : op(OpCode::AddVar), s});
+        } else {
+            emit(rhs);
+            program.code.push_back({safe ? OpCode::DivUnchecked : op(OpCode::Add), 0});
+            --depth;
+        }
+
+        if (shared) {
+            auto temp = static_cast<int32_t>(program.temps++);
+            program.code.push_back({OpCode::StoreTemp, temp});
+            tempOf.emplace(&e, temp);
+        }
+    }
+
+    static BytecodeProgram build(const Expression& e, VariableLayout layout, const RangeAnalysis* ranges) {
+        BytecodeCompiler compiler(std::move(layout));
+        compiler.ranges = ranges;
+        compiler.countParents(e);
+        compiler.emit(e);
+        return std::move(compiler.program);
+    }
+
+public:
+    // Связывание с заданной раскладкой: бросает std::logic_error,
+    // если в выражении есть переменная, которой в раскладке нет
+    static BytecodeProgram compile(const Expression& e, VariableLayout layout) {
+        return build(e, std::move(layout), nullptr);
+    }
+
+    static BytecodeProgram compile(const ExprPtr& e, VariableLayout layout) {
+        return compile(*e, std::move(layout));
+    }
+
+    // С результатами интервального анализа того же выражения: доказанно
+    // безопасные деления компилируются без проверок
+    static BytecodeProgram compile(const Expression& e, VariableLayout layout, const RangeAnalysis& ranges) {
+        return build(e, std::move(layout), &ranges);
+    }
+
+    // Раскладка из переменных самого выражения
+    static BytecodeProgram compile(const Expression& e) {
+        return compile(e, VariableLayout::of(e));
+    }
+
+    static BytecodeProgram compile(const ExprPtr& e) {
+        return compile(*e);
+    }
+};
+
+#endif //BYTECODE_H
@@ -0,0 +1,238 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include "ValueTraits.hpp"
+#include "SymbolTable.hpp"
+
+// Вид узла AST: позволяет проходам по дереву (компиляция, оптимизация...)
+// разбирать узлы без dynamic_cast
+enum class ExprKind : uint8_t {
+    Constant,
+    Variable,
+    Add,
+    Subtract,
+    Multiply,
+    IntegerDivide,
+};
+
+// Символ бинарной операции (для вывода)
+inline const char* operatorSymbol(ExprKind kind) {
+    switch (kind) {
+        case ExprKind::Add: return "+";
+        case ExprKind::Subtract: return "-";
+        case ExprKind::Multiply: return "*";
+        case ExprKind::IntegerDivide: return "//";
+        default: return "?";
+    }
+}
+
+// Базовый интерфейс для всех выражений в AST (Abstract Syntax Tree)
+// Определяет основные операции, которые должны поддерживать все выражения.
+// V - тип значения (int32_t, int64_t, double, Checked<...>); семантика
+// операций для него задаётся ValueTraits<V>
+template<class V>
+class BasicExpression {
+public:
+    using Value = V;
+    using Context = std::map<std::string, V>;
+    using SymbolContext = BasicSymbolContext<V>;
+
+    virtual ~BasicExpression() = default;
+    
+    // Выводит текстовое представление выражения в выходной поток
+    virtual void print(std::ostream& os) const = 0;
+    
+    // Вычисляет значение выражения с использованием переданных переменных
+    virtual V evaluate(const Context& vars) const = 0;
+
+    // То же по контексту, индексируемому номерами символов: без работы со строками
+    virtual V evaluate(const SymbolContext& vars) const = 0;
+
+    // Вид узла
+    virtual ExprKind kind() const = 0;
+};
+
+template<class V>
+using BasicExprPtr = std::shared_ptr<BasicExpression<V>>;
+
+//------------------------------
+// Листовые узлы AST (терминальные выражения)
+//------------------------------
+
+// Константное значение
+template<class V>
+class BasicConstant : public BasicExpression<V> {
+    V value;
+public:
+    explicit BasicConstant(V v) : value(v) {}
+    
+    void print(std::ostream& os) const override { os << value; }
+    
+    V evaluate(const typename BasicExpression<V>::Context&) const override {
+        return value; 
+    }
+
+    V evaluate(const typename BasicExpression<V>::SymbolContext&) const override {
+        return value;
+    }
+
+    ExprKind kind() const override { return ExprKind::Constant; }
+
+    V getValue() const { return value; }
+};
+
+// Переменная, значение которой берется из контекста.
+// Имя переводится в номер SymbolTable один раз, при создании узла
+template<class V>
+class BasicVariable : public BasicExpression<V> {
+    std::string name;
+    SymbolId id;
+public:
+    explicit BasicVariable(std::string n) : name(std::move(n)), id(SymbolTable::instance().intern(name)) {}
+
+    explicit BasicVariable(SymbolId symbol) : name(SymbolTable::instance().name(symbol)), id(symbol) {}
+    
+    void print(std::ostream& os) const override { os << name; }
+    
+    V evaluate(const typename BasicExpression<V>::Context& vars) const override {
+        // Один поиск по дереву вместо contains + at
+        auto it = vars.find(name);
+        if (it == vars.end()) {
+            throw std::logic_error("Variable " + name + " does not exist!");
+        }
+        return it->second;
+    }
+
+    V evaluate(const typename BasicExpression<V>::SymbolContext& vars) const override {
+        return vars.get(id);
+    }
+
+    ExprKind kind() const override { return ExprKind::Variable; }
+
+    const std::string& getName() const { return name; }
+    SymbolId getId() const { return id; }
+};
+
+//------------------------------
+// Составные узлы AST (нетерминальные выражения)
+//------------------------------
+
+// Базовый класс для всех бинарных операций
+template<class V>
+class BasicBinaryOp : public BasicExpression<V> {
+protected:
+    using Traits = ValueTraits<V>;
+    using Context = typename BasicExpression<V>::Context;
+    using SymbolContext = typename BasicExpression<V>::SymbolContext;
+
+    BasicExprPtr<V> left;   // Левый операнд
+    BasicExprPtr<V> right;  // Правый операнд
+    
+public:
+    BasicBinaryOp(BasicExprPtr<V> l, BasicExprPtr<V> r)
+        : left(std::move(l)), right(std::move(r)) {}
+        
+    // Символ операции берётся по виду узла, а не хранится строкой в каждом узле
+    void print(std::ostream& os) const override {
+        os << "(";
+        left->print(os);
+        os << ' ' << operatorSymbol(this->kind()) << ' ';
+        right->print(os);
+        os << ")";
+    }
+
+    const BasicExprPtr<V>& getLeft() const { return left; }
+    const BasicExprPtr<V>& getRight() const { return right; }
+};
+
+// Операция сложения (+)
+template<class V>
+class BasicAdd : public BasicBinaryOp<V> {
+    template<class C>
+    V compute(const C& vars) const {
+        return BasicBinaryOp<V>::Traits::add(this->left->evaluate(vars), this->right->evaluate(vars));
+    }
+
+public:
+    BasicAdd(BasicExprPtr<V> l, BasicExprPtr<V> r) : BasicBinaryOp<V>(std::move(l), std::move(r)) {}
+    
+    V evaluate(const typename BasicBinaryOp<V>::Context& vars) const override { return compute(vars); }
+    V evaluate(const typename BasicBinaryOp<V>::SymbolContext& vars) const override { return compute(vars); }
+
+    ExprKind kind() const override { return ExprKind::Add; }
+};
+
+// Операция вычитания (-)
+template<class V>
+class BasicSubtract : public BasicBinaryOp<V> {
+    template<class C>
+    V compute(const C& vars) const {
+        return BasicBinaryOp<V>::Traits::subtract(this->left->evaluate(vars), this->right->evaluate(vars));
+    }
+
+public:
+    BasicSubtract(BasicExprPtr<V> l, BasicExprPtr<V> r) : BasicBinaryOp<V>(std::move(l), std::move(r)) {}
+    
+    V evaluate(const typename BasicBinaryOp<V>::Context& vars) const override { return compute(vars); }
+    V evaluate(const typename BasicBinaryOp<V>::SymbolContext& vars) const override { return compute(vars); }
+
+    ExprKind kind() const override { return ExprKind::Subtract; }
+};
+
+// Операция целочисленного деления (//): делитель вычисляется первым,
+// семантика (усечение, ноль, переполнение) - ValueTraits<V>::divide
+template<class V>
+class BasicIntegerDivide : public BasicBinaryOp<V> {
+    template<class C>
+    V compute(const C& vars) const {
+        V divisor = this->right->evaluate(vars);
+        return BasicBinaryOp<V>::Traits::divide(this->left->evaluate(vars), divisor);
+    }
+
+public:
+    BasicIntegerDivide(BasicExprPtr<V> l, BasicExprPtr<V> r) : BasicBinaryOp<V>(std::move(l), std::move(r)) {}
+    
+    V evaluate(const typename BasicBinaryOp<V>::Context& vars) const override { return compute(vars); }
+    V evaluate(const typename BasicBinaryOp<V>::SymbolContext& vars) const override { return compute(vars); }
+
+    ExprKind kind() const override { return ExprKind::IntegerDivide; }
+};
+
+// Операция умножения (*)
+
+template<class V>
+class BasicMultiply : public BasicBinaryOp<V> {
+    template<class C>
+    V compute(const C& vars) const {
+        return BasicBinaryOp<V>::Traits::multiply(this->left->evaluate(vars), this->right->evaluate(vars));
+    }
+
+public:
+    BasicMultiply(BasicExprPtr<V> l, BasicExprPtr<V> r) : BasicBinaryOp<V>(std::move(l), std::move(r)) {}
+    
+    V evaluate(const typename BasicBinaryOp<V>::Context& vars) const override { return compute(vars); }
+    V evaluate(const typename BasicBinaryOp<V>::SymbolContext& vars) const override { return compute(vars); }
+
+    ExprKind kind() const override { return ExprKind::Multiply; }
+};
+
+//------------------------------
+// Выражения над int - с ними работают фабрика, компиляторы и вычислители task 8
+//------------------------------
+using Expression = BasicExpression<int>;
+using ExprPtr = std::shared_ptr<Expression>; // Удобный псевдоним для shared_ptr
+using Constant = BasicConstant<int>;
+using Variable = BasicVariable<int>;
+using BinaryOp = BasicBinaryOp<int>;
+using Add = BasicAdd<int>;
+using Subtract = BasicSubtract<int>;
+using IntegerDivide = BasicIntegerDivide<int>;
+using Multiply = BasicMultiply<int>;
+
+#endif //EXPRESSION_H
@@ -0,0 +1,165 @@
+#ifndef EXPRESSIONARENA_H
+#define EXPRESSIONARENA_H
+
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "ExpressionFactory.hpp"
+#include "VariableLayout.hpp"
+
+// Узел арены - 12 байт: вид и два 32-битных поля.
+// Константа хранит значение в lhs, переменная - номер слота раскладки,
+// бинарная операция - индексы операндов. Операнды всегда создаются раньше
+// родителя, так что их индексы меньше индекса родителя
+struct ArenaNode {
+    ExprKind kind;
+    uint32_t lhs;
+    uint32_t rhs;
+};
+
+//------------------------------
+// Арена выражений: все узлы лежат подряд в одном векторе, без отдельных
+// аллокаций, счётчиков ссылок и виртуальных вызовов. Освобождается целиком:
+// clear() или rewind(mark) сбрасывает всё, что создано после метки
+//------------------------------
+class ExpressionArena {
+public:
+    using NodeId = uint32_t;
+
+private:
+    std::vector<ArenaNode> nodes;
+    VariableLayout layout_;
+
+    NodeId push(ExprKind kind, uint32_t lhs, uint32_t rhs) {
+        nodes.push_back({kind, lhs, rhs});
+        return static_cast<NodeId>(nodes.size() - 1);
+    }
+
+    void check(NodeId id) const {
+        if (id >= nodes.size()) throw std::logic_error("Arena node index out of range");
+    }
+
+    NodeId importNode(const Expression& e, std::unordered_map<const Expression*, NodeId>& done) {
+        if (auto it = done.find(&e); it != done.end()) return it->second;
+        NodeId id;
+        switch (e.kind()) {
+            case ExprKind::Constant: id = constant(static_cast<const Constant&>(e).getValue()); break;
+            case ExprKind::Variable: id = variable(static_cast<const Variable&>(e).getName()); break;
+            default: {
+                auto& bin = static_cast<const BinaryOp&>(e);
+                NodeId l = importNode(*bin.getLeft(), done);
+                NodeId r = importNode(*bin.getRight(), done);
+                id = push(e.kind(), l, r);
+            }
+        }
+        done.emplace(&e, id);
+        return id;
+    }
+
+public:
+    ExpressionArena() = default;
+
+    // Раскладка задаёт слоты переменных; новые имена дописываются в её конец
+    explicit ExpressionArena(VariableLayout layout) : layout_(std::move(layout)) {}
+
+    NodeId constant(int value) {
+        return push(ExprKind::Constant, std::bit_cast<uint32_t>(value), 0);
+    }
+
+    NodeId variable(const std::string& name) {
+        return push(ExprKind::Variable, static_cast<uint32_t>(layout_.add(name)), 0);
+    }
+
+    NodeId binary(ExprKind kind, NodeId l, NodeId r) {
+        check(l);
+        check(r);
+        if (kind == ExprKind::Constant || kind == ExprKind::Variable) throw std::logic_error("Not a binary operation");
+        return push(kind, l, r);
+    }
+
+    NodeId add(NodeId l, NodeId r) { return binary(ExprKind::Add, l, r); }
+    NodeId subtract(NodeId l, NodeId r) { return binary(ExprKind::Subtract, l, r); }
+    NodeId multiply(NodeId l, NodeId r) { return binary(ExprKind::Multiply, l, r); }
+    NodeId integerDivide(NodeId l, NodeId r) { return binary(ExprKind::IntegerDivide, l, r); }
+
+    // Копия выражения из shared_ptr-узлов; общие узлы копируются один раз
+    NodeId import(const Expression& e) {
+        std::unordered_map<const Expression*, NodeId> done;
+        return importNode(e, done);
+    }
+
+    // Обратно в узлы ExpressionFactory
+    ExprPtr toExpression(NodeId id) const {
+        check(id);
+        const ArenaNode& n = nodes[id];
+        auto& factory = ExpressionFactory::instance();
+        switch (n.kind) {
+            case ExprKind::Constant: return factory.getConstant(std::bit_cast<int>(n.lhs));
+            case ExprKind::Variable: return factory.getVariable(layout_.variables()[n.lhs]);
+            default: return factory.getBinary(n.kind, toExpression(n.lhs), toExpression(n.rhs));
+        }
+    }
+
+    // Вычисление по контексту, разложенному по слотам layout()
+    int evaluate(NodeId id, std::span<const int> slots) const {
+        check(id);
+        if (slots.size() < layout_.size()) throw std::logic_error("Context has fewer slots than the layout");
+        return evaluateNode(id, slots.data());
+    }
+
+    int evaluate(NodeId id, const std::map<std::string, int>& vars) const {
+        return evaluate(id, layout_.makeContext(vars));
+    }
+
+    void print(NodeId id, std::ostream& os) const {
+        check(id);
+        const ArenaNode& n = nodes[id];
+        switch (n.kind) {
+            case ExprKind::Constant: os << std::bit_cast<int>(n.lhs); return;
+            case ExprKind::Variable: os << layout_.variables()[n.lhs]; return;
+            default:
+                os << '(';
+                print(n.lhs, os);
+                os << ' ' << operatorSymbol(n.kind) << ' ';
+                print(n.rhs, os);
+                os << ')';
+        }
+    }
+
+    // Метка текущего размера; rewind(mark) освобождает всё созданное после неё
+    size_t mark() const { return nodes.size(); }
+
+    void rewind(size_t mark) {
+        if (mark < nodes.size()) nodes.resize(mark);
+    }
+
+    void clear() { nodes.clear(); }
+
+    const VariableLayout& layout() const { return layout_; }
+    std::span<const ArenaNode> data() const { return nodes; }
+    size_t size() const { return nodes.size(); }
+    size_t memoryUsage() const { return nodes.capacity() * sizeof(ArenaNode); }
+
+private:
+    // Семантика операций - ValueTraits<int>, как у остальных движков:
+    // переполнение заворачивается, INT_MIN // -1 не бросает #DE
+    int evaluateNode(NodeId id, const int* slots) const {
+        using T = ValueTraits<int>;
+        const ArenaNode& n = nodes[id];
+        switch (n.kind) {
+            case ExprKind::Constant: return std::bit_cast<int>(n.lhs);
+            case ExprKind::Variable: return slots[n.lhs];
+            case ExprKind::Add: return T::add(evaluateNode(n.lhs, slots), evaluateNode(n.rhs, slots));
+            case ExprKind::Subtract: return T::subtract(evaluateNode(n.lhs, slots), evaluateNode(n.rhs, slots));
+            case ExprKind::Multiply: return T::multiply(evaluateNode(n.lhs, slots), evaluateNode(n.rhs, slots));
+            default: {
+                int divisor = evaluateNode(n.rhs, slots);
+                return T::divide(evaluateNode(n.lhs, slots), divisor);
+            }
+        }
+    }
+};
+
+#endif //EXPRESSIONARENA_H
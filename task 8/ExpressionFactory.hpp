@@ -0,0 +1,202 @@
+#ifndef EXPRESSIONFACTORY_H
+#define EXPRESSIONFACTORY_H
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <string_view>
+#include <tuple>
+#include "Expression.hpp"
+#include "FlatHashMap.hpp"
+
+namespace task_8 {
+    // Пул интернированных узлов: ключ -> weak_ptr на узел.
+    // Мёртвые записи вычищаются не на каждом запросе, а пачкой, когда пул
+    // вырастает вдвое с момента прошлой чистки: чистка стоит O(размер пула),
+    // а перед ней было не меньше половины стольких же вставок - амортизированно O(1)
+    template<class K, class Node, class Hash = std::hash<K>>
+    class InternPool {
+        static constexpr size_t kMinSweep = 1024;
+
+        FlatHashMap<K, std::weak_ptr<Node>, Hash> pool;
+        size_t sweepAt = kMinSweep;
+
+    public:
+        // Живой узел по ключу или новый из make()
+        template<class Q, class Make>
+        std::shared_ptr<Node> get(const Q& key, Make make) {
+            if (auto* wp = pool.find(key)) {
+                if (auto sp = wp->lock()) return sp;
+                auto sp = make();
+                *wp = sp;  // Переиспользуем запись мёртвого узла
+                return sp;
+            }
+            if (pool.size() >= sweepAt) sweep();
+            auto sp = make();
+            *pool.tryEmplace(key).first = sp;
+            return sp;
+        }
+
+        // Удаляет записи мёртвых узлов, возвращает их число
+        size_t sweep() {
+            size_t removed = pool.eraseIf([](const K&, const std::weak_ptr<Node>& wp) { return wp.expired(); });
+            sweepAt = std::max(kMinSweep, 2 * pool.size());
+            return removed;
+        }
+
+        size_t size() const { return pool.size(); }
+    };
+
+    // Потокобезопасный пул: Shards независимых InternPool, каждый под своим
+    // мьютексом. Шард выбирается по хешу ключа, так что запросы к разным
+    // ключам почти всегда берут разные мьютексы и не мешают друг другу
+    template<class K, class Node, class Hash = std::hash<K>, size_t Shards = 16>
+    class ShardedInternPool {
+        static_assert((Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+
+        // Шард на своей кеш-линии, чтобы соседние мьютексы не делили её
+        struct alignas(64) Shard {
+            std::mutex mutex;
+            InternPool<K, Node, Hash> pool;
+        };
+
+        std::array<Shard, Shards> shards;
+        [[no_unique_address]] Hash hasher;
+
+        // Старшие биты перемешанного хеша: FlatHashMap внутри шарда берёт младшие
+        template<class Q>
+        Shard& shardFor(const Q& key) {
+            uint64_t h = hasher(key);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdull;
+            h ^= h >> 33;
+            return shards[(h >> 32) & (Shards - 1)];
+        }
+
+    public:
+        template<class Q, class Make>
+        std::shared_ptr<Node> get(const Q& key, Make make) {
+            Shard& shard = shardFor(key);
+            std::lock_guard lock(shard.mutex);
+            return shard.pool.get(key, make);
+        }
+
+        size_t sweep() {
+            size_t removed = 0;
+            for (Shard& shard : shards) {
+                std::lock_guard lock(shard.mutex);
+                removed += shard.pool.sweep();
+            }
+            return removed;
+        }
+
+        size_t size() {
+            size_t total = 0;
+            for (Shard& shard : shards) {
+                std::lock_guard lock(shard.mutex);
+                total += shard.pool.size();
+            }
+            return total;
+        }
+    };
+
+    // Хеш ключа составного узла
+    struct BinaryKeyHash {
+        size_t operator()(const std::tuple<ExprKind, const Expression*, const Expression*>& key) const {
+            auto [kind, l, r] = key;
+            size_t h = std::hash<const Expression*>{}(l);
+            h = h * 0x9e3779b97f4a7c15ull ^ std::hash<const Expression*>{}(r);
+            return h * 31 + static_cast<size_t>(kind);
+        }
+    };
+}
+
+//------------------------------
+// Фабрика выражений (реализована как Singleton)
+// Использует пулы объектов для хранения констант, переменных и составных узлов.
+// Потокобезопасна: пулы разбиты на шарды со своими мьютексами.
+// Составные узлы хешируются по (вид, левый операнд, правый операнд): раз операнды
+// уже единственны, равенство указателей на них означает структурное равенство,
+// и одинаковые подвыражения, собранные через фабрику, - это один узел (DAG)
+//------------------------------
+class ExpressionFactory {
+    using BinaryKey = std::tuple<ExprKind, const Expression*, const Expression*>;
+
+    task_8::ShardedInternPool<int, Constant> constPool;      // Пул констант
+    task_8::ShardedInternPool<SymbolId, Variable> varPool;   // Пул переменных (по номеру символа)
+    task_8::ShardedInternPool<BinaryKey, Expression, task_8::BinaryKeyHash> binaryPool;    // Пул составных узлов
+
+    // Получение составного узла (с использованием пула). Пока узел жив, он
+    // владеет операндами, поэтому их адреса в ключе не могут быть переиспользованы
+    template<class Op>
+    ExprPtr intern(ExprKind kind, ExprPtr l, ExprPtr r) {
+        BinaryKey key{kind, l.get(), r.get()};
+        return binaryPool.get(key, [&] { return std::make_shared<Op>(std::move(l), std::move(r)); });
+    }
+
+    // Приватный конструктор для Singleton
+    ExpressionFactory() = default;
+    
+public:
+    // Получение экземпляра фабрики
+    static ExpressionFactory& instance() {
+        static ExpressionFactory factory;
+        return factory;
+    }
+
+
+    // Получение константы (с использованием пула)
+    ExprPtr getConstant(int v) {
+        return constPool.get(v, [v] { return std::make_shared<Constant>(v); });
+    }
+
+    // Получение переменной (с использованием пула): имя хешируется один раз,
+    // в SymbolTable, пул переменных работает с номером
+    ExprPtr getVariable(std::string_view name) {
+        return getVariable(SymbolTable::instance().intern(name));
+    }
+
+    ExprPtr getVariable(SymbolId id) {
+        return varPool.get(id, [id] { return std::make_shared<Variable>(id); });
+    }
+
+    // Получение составных узлов
+    ExprPtr getAdd(ExprPtr l, ExprPtr r) {
+        return intern<Add>(ExprKind::Add, std::move(l), std::move(r));
+    }
+
+    ExprPtr getSubtract(ExprPtr l, ExprPtr r) {
+        return intern<Subtract>(ExprKind::Subtract, std::move(l), std::move(r));
+    }
+
+    ExprPtr getMultiply(ExprPtr l, ExprPtr r) {
+        return intern<Multiply>(ExprKind::Multiply, std::move(l), std::move(r));
+    }
+
+    ExprPtr getIntegerDivide(ExprPtr l, ExprPtr r) {
+        return intern<IntegerDivide>(ExprKind::IntegerDivide, std::move(l), std::move(r));
+    }
+
+    // Узел вида kind с данными операндами (kind - одна из бинарных операций)
+    ExprPtr getBinary(ExprKind kind, ExprPtr l, ExprPtr r) {
+        switch (kind) {
+            case ExprKind::Add: return getAdd(std::move(l), std::move(r));
+            case ExprKind::Subtract: return getSubtract(std::move(l), std::move(r));
+            case ExprKind::Multiply: return getMultiply(std::move(l), std::move(r));
+            case ExprKind::IntegerDivide: return getIntegerDivide(std::move(l), std::move(r));
+            default: throw std::logic_error("Not a binary operation");
+        }
+    }
+
+    // Внеочередная очистка пулов от "мёртвых" weak_ptr; возвращает число удалённых
+    size_t prune() {
+        return constPool.sweep() + varPool.sweep() + binaryPool.sweep();
+    }
+
+    // Число записей в пулах (включая ещё не вычищенные мёртвые)
+    size_t poolSize() {
+        return constPool.size() + varPool.size() + binaryPool.size();
+    }
+};
+
+#endif //EXPRESSIONFACTORY_H
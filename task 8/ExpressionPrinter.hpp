@@ -0,0 +1,108 @@
+#ifndef EXPRESSIONPRINTER_H
+#define EXPRESSIONPRINTER_H
+
+#include <charconv>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Expression.hpp"
+
+//------------------------------
+// Вывод выражений в собственный буфер символов: константы - через
+// std::to_chars, обход - итеративный, со своим стеком вместо рекурсии
+// (глубина выражения не ограничена стеком вызова). Буфер и стек обхода
+// переиспользуются между вызовами, так что после прогрева вывод не выделяет
+// памяти. Результат побайтно совпадает с Expression::print
+//------------------------------
+class ExpressionPrinter {
+    // Элемент стека обхода: узел, который ещё надо вывести, или готовый текст
+    struct Item {
+        const Expression* node;
+        std::string_view text;
+    };
+
+    std::string buffer;
+    std::vector<Item> stack;
+
+    // Символ операции с пробелами вокруг, как в BinaryOp::print
+    static std::string_view infix(ExprKind kind) {
+        switch (kind) {
+            case ExprKind::Add: return " + ";
+            case ExprKind::Subtract: return " - ";
+            case ExprKind::Multiply: return " * ";
+            case ExprKind::IntegerDivide: return " // ";
+            default: return " ? ";
+        }
+    }
+
+    void appendInt(int value) {
+        char digits[16];
+        auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, end);
+    }
+
+public:
+    // Дописывает выражение в конец буфера
+    ExpressionPrinter& append(const Expression& e) {
+        stack.push_back({&e, {}});
+        while (!stack.empty()) {
+            Item item = stack.back();
+            stack.pop_back();
+            if (!item.node) {
+                buffer.append(item.text);
+                continue;
+            }
+            switch (item.node->kind()) {
+                case ExprKind::Constant:
+                    appendInt(static_cast<const Constant&>(*item.node).getValue());
+                    break;
+                case ExprKind::Variable:
+                    buffer.append(static_cast<const Variable&>(*item.node).getName());
+                    break;
+                default: {
+                    // "(" - сразу, остальное - на стек в обратном порядке
+                    auto& bin = static_cast<const BinaryOp&>(*item.node);
+                    buffer.push_back('(');
+                    stack.push_back({nullptr, ")"});
+                    stack.push_back({bin.getRight().get(), {}});
+                    stack.push_back({nullptr, infix(item.node->kind())});
+                    stack.push_back({bin.getLeft().get(), {}});
+                }
+            }
+        }
+        return *this;
+    }
+
+    ExpressionPrinter& append(std::string_view text) {
+        buffer.append(text);
+        return *this;
+    }
+
+    ExpressionPrinter& append(char c) {
+        buffer.push_back(c);
+        return *this;
+    }
+
+    // Накопленный текст; действителен до следующего изменения буфера
+    std::string_view view() const { return buffer; }
+    size_t size() const { return buffer.size(); }
+
+    // Очищает буфер, сохраняя выделенную память
+    void clear() { buffer.clear(); }
+
+    // Записывает накопленное в поток одним вызовом и очищает буфер
+    void flush(std::ostream& os) {
+        os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    // Текст одного выражения
+    static std::string toString(const Expression& e) {
+        ExpressionPrinter printer;
+        printer.append(e);
+        return std::move(printer.buffer);
+    }
+};
+
+#endif //EXPRESSIONPRINTER_H
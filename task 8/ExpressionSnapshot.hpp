@@ -0,0 +1,275 @@
+#ifndef EXPRESSIONSNAPSHOT_H
+#define EXPRESSIONSNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ExpressionFactory.hpp"
+#include "VariableLayout.hpp"
+#include "../common/MappedFile.hpp"
+
+// Снимок набора выражений на диске: DAG целиком, общие узлы - один раз.
+// Секции идут подряд с выравниванием по 64 байта:
+//   заголовок | узлы (12 байт) | корни | константы | смещения имён | имена
+// Узел - вид и два 32-битных поля, как ArenaNode: у константы lhs - номер
+// в таблице констант, у переменной - номер имени (он же слот раскладки),
+// у бинарной операции - индексы операндов, всегда меньшие индекса узла.
+// Вычисление идёт прямо по отображённой памяти, без shared_ptr-узлов.
+// Порядок байт - родной для машины, на другую архитектуру файлы не переносятся.
+
+namespace task_8 {
+    constexpr char kSnapshotMagic[8] = {'E', 'X', 'P', 'R', 'D', 'A', 'G', '1'};
+    using common::MappedFile;
+    using common::SnapshotWriter;
+    using common::alignUp;
+    constexpr size_t kSnapshotAlign = common::kSectionAlign;
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t nodeCount;
+        uint32_t rootCount;
+        uint32_t constantCount;
+        uint32_t symbolCount;
+        uint32_t symbolBytes;  // Суммарная длина имён
+        uint32_t reserved[9];
+    };
+    static_assert(sizeof(SnapshotHeader) == kSnapshotAlign);
+
+    // Узел на диске: явные байты выравнивания, чтобы файл не зависел от мусора в padding
+    struct SnapshotNode {
+        ExprKind kind;
+        uint8_t padding[3];
+        uint32_t lhs;
+        uint32_t rhs;
+    };
+    static_assert(sizeof(SnapshotNode) == 12);
+
+    // Сборка таблиц снимка из shared_ptr-узлов
+    class SnapshotBuilder {
+        std::vector<SnapshotNode> nodes;
+        std::vector<int> constants;
+        VariableLayout symbols;
+        std::unordered_map<const Expression*, uint32_t> done;
+        std::unordered_map<int, uint32_t> constantIndex;
+
+        uint32_t push(ExprKind kind, uint32_t lhs, uint32_t rhs) {
+            if (nodes.size() >= UINT32_MAX) throw std::logic_error("Too many nodes for a snapshot");
+            SnapshotNode node{};
+            node.kind = kind;
+            node.lhs = lhs;
+            node.rhs = rhs;
+            nodes.push_back(node);
+            return static_cast<uint32_t>(nodes.size() - 1);
+        }
+
+    public:
+        uint32_t import(const Expression& e) {
+            if (auto it = done.find(&e); it != done.end()) return it->second;
+            uint32_t id;
+            switch (e.kind()) {
+                case ExprKind::Constant: {
+                    int value = static_cast<const Constant&>(e).getValue();
+                    auto [it, inserted] = constantIndex.try_emplace(value, static_cast<uint32_t>(constants.size()));
+                    if (inserted) constants.push_back(value);
+                    id = push(ExprKind::Constant, it->second, 0);
+                    break;
+                }
+                case ExprKind::Variable:
+                    id = push(ExprKind::Variable, static_cast<uint32_t>(symbols.add(static_cast<const Variable&>(e).getName())), 0);
+                    break;
+                default: {
+                    auto& bin = static_cast<const BinaryOp&>(e);
+                    uint32_t l = import(*bin.getLeft());
+                    uint32_t r = import(*bin.getRight());
+                    id = push(e.kind(), l, r);
+                }
+            }
+            done.emplace(&e, id);
+            return id;
+        }
+
+        void write(const std::string& path, std::span<const uint32_t> roots) const {
+            std::vector<uint32_t> offsets{0};
+            std::string names;
+            for (const auto& name : symbols.variables()) {
+                names += name;
+                offsets.push_back(static_cast<uint32_t>(names.size()));
+            }
+
+            SnapshotHeader header{};
+            std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+            header.nodeCount = static_cast<uint32_t>(nodes.size());
+            header.rootCount = static_cast<uint32_t>(roots.size());
+            header.constantCount = static_cast<uint32_t>(constants.size());
+            header.symbolCount = static_cast<uint32_t>(symbols.size());
+            header.symbolBytes = static_cast<uint32_t>(names.size());
+
+            SnapshotWriter out(path);
+            out.write(std::span<const SnapshotHeader>(&header, 1));
+            out.write(std::span<const SnapshotNode>(nodes));
+            out.write(roots);
+            out.write(std::span<const int>(constants));
+            out.write(std::span<const uint32_t>(offsets));
+            out.write(std::span<const char>(names));
+            out.finish();
+        }
+    };
+}
+
+//------------------------------
+// Набор выражений, открытый из снимка. Открытие - один mmap и разбор
+// заголовка и таблицы имён; узлы не разбираются и не копируются, страницы
+// подгружаются ОС при первом обращении. Только для чтения
+//------------------------------
+class MappedExpressions {
+    task_8::MappedFile file_;
+    std::span<const task_8::SnapshotNode> nodes_;
+    std::span<const uint32_t> roots_;
+    std::span<const int> constants_;
+    VariableLayout layout_;
+
+    void checkRoot(size_t root) const {
+        if (root >= roots_.size()) throw std::logic_error("Snapshot root index out of range");
+    }
+
+    int evaluateNode(uint32_t id, const int* slots) const {
+        using T = ValueTraits<int>;
+        const task_8::SnapshotNode& n = nodes_[id];
+        switch (n.kind) {
+            case ExprKind::Constant: return constants_[n.lhs];
+            case ExprKind::Variable: return slots[n.lhs];
+            case ExprKind::Add: return T::add(evaluateNode(n.lhs, slots), evaluateNode(n.rhs, slots));
+            case ExprKind::Subtract: return T::subtract(evaluateNode(n.lhs, slots), evaluateNode(n.rhs, slots));
+            case ExprKind::Multiply: return T::multiply(evaluateNode(n.lhs, slots), evaluateNode(n.rhs, slots));
+            default: {
+                int divisor = evaluateNode(n.rhs, slots);
+                return T::divide(evaluateNode(n.lhs, slots), divisor);
+            }
+        }
+    }
+
+    ExprPtr toExpressionNode(uint32_t id, std::unordered_map<uint32_t, ExprPtr>& done) const {
+        if (auto it = done.find(id); it != done.end()) return it->second;
+        const task_8::SnapshotNode& n = nodes_[id];
+        auto& factory = ExpressionFactory::instance();
+        ExprPtr e;
+        switch (n.kind) {
+            case ExprKind::Constant: e = factory.getConstant(constants_[n.lhs]); break;
+            case ExprKind::Variable: e = factory.getVariable(layout_.variables()[n.lhs]); break;
+            default: e = factory.getBinary(n.kind, toExpressionNode(n.lhs, done), toExpressionNode(n.rhs, done));
+        }
+        done.emplace(id, e);
+        return e;
+    }
+
+    void printNode(uint32_t id, std::ostream& os) const {
+        const task_8::SnapshotNode& n = nodes_[id];
+        switch (n.kind) {
+            case ExprKind::Constant: os << constants_[n.lhs]; return;
+            case ExprKind::Variable: os << layout_.variables()[n.lhs]; return;
+            default:
+                os << '(';
+                printNode(n.lhs, os);
+                os << ' ' << operatorSymbol(n.kind) << ' ';
+                printNode(n.rhs, os);
+                os << ')';
+        }
+    }
+
+public:
+    // Записывает выражения в снимок; общие узлы (например, из ExpressionFactory)
+    // записываются один раз, одинаковые константы - тоже
+    static void save(const std::string& path, std::span<const ExprPtr> exprs) {
+        task_8::SnapshotBuilder builder;
+        std::vector<uint32_t> roots;
+        roots.reserve(exprs.size());
+        for (const auto& e : exprs) roots.push_back(builder.import(*e));
+        builder.write(path, roots);
+    }
+
+    // Проверяет заголовок и границы секций. Содержимое узлов не проверяется,
+    // чтобы не читать весь файл при открытии; для недоверенных файлов - verify()
+    explicit MappedExpressions(const std::string& path) : file_(path) {
+        using namespace task_8;
+        const auto& header = file_.section<SnapshotHeader>(0, 1)[0];
+        if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("not an expression snapshot: " + path);
+        }
+        size_t offset = alignUp(sizeof(SnapshotHeader));
+        nodes_ = file_.section<SnapshotNode>(offset, header.nodeCount);
+        offset += alignUp(nodes_.size_bytes());
+        roots_ = file_.section<uint32_t>(offset, header.rootCount);
+        offset += alignUp(roots_.size_bytes());
+        constants_ = file_.section<int>(offset, header.constantCount);
+        offset += alignUp(constants_.size_bytes());
+        auto offsets = file_.section<uint32_t>(offset, size_t{header.symbolCount} + 1);
+        offset += alignUp(offsets.size_bytes());
+        auto names = file_.section<char>(offset, header.symbolBytes);
+
+        for (size_t i = 0; i < header.symbolCount; ++i) {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > names.size()) {
+                throw std::runtime_error("corrupted snapshot: symbol table out of bounds");
+            }
+            layout_.add(std::string(names.data() + offsets[i], offsets[i + 1] - offsets[i]));
+        }
+        if (layout_.size() != header.symbolCount) throw std::runtime_error("corrupted snapshot: duplicate symbols");
+    }
+
+    // Полная проверка узлов и корней: виды, индексы в таблицах и порядок
+    // операндов (они раньше родителя, так что циклов нет)
+    void verify() const {
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            const auto& n = nodes_[i];
+            bool ok;
+            switch (n.kind) {
+                case ExprKind::Constant: ok = n.lhs < constants_.size(); break;
+                case ExprKind::Variable: ok = n.lhs < layout_.size(); break;
+                case ExprKind::Add:
+                case ExprKind::Subtract:
+                case ExprKind::Multiply:
+                case ExprKind::IntegerDivide: ok = n.lhs < i && n.rhs < i; break;
+                default: ok = false;
+            }
+            if (!ok) throw std::runtime_error("corrupted snapshot: bad node " + std::to_string(i));
+        }
+        for (uint32_t root : roots_) {
+            if (root >= nodes_.size()) throw std::runtime_error("corrupted snapshot: bad root");
+        }
+    }
+
+    // Вычисление по контексту, разложенному по слотам layout()
+    int evaluate(size_t root, std::span<const int> slots) const {
+        checkRoot(root);
+        if (slots.size() < layout_.size()) throw std::logic_error("Context has fewer slots than the layout");
+        return evaluateNode(roots_[root], slots.data());
+    }
+
+    int evaluate(size_t root, const std::map<std::string, int>& vars) const {
+        return evaluate(root, layout_.makeContext(vars));
+    }
+
+    // Обратно в узлы ExpressionFactory (когда нужен байткод, JIT и т.п.)
+    ExprPtr toExpression(size_t root) const {
+        checkRoot(root);
+        std::unordered_map<uint32_t, ExprPtr> done;
+        return toExpressionNode(roots_[root], done);
+    }
+
+    void print(size_t root, std::ostream& os) const {
+        checkRoot(root);
+        printNode(roots_[root], os);
+    }
+
+    // Раскладка контекста: слоты - имена из таблицы снимка
+    const VariableLayout& layout() const { return layout_; }
+    size_t size() const { return roots_.size(); }
+    size_t nodeCount() const { return nodes_.size(); }
+    size_t fileSize() const { return file_.size(); }
+};
+
+#endif //EXPRESSIONSNAPSHOT_H
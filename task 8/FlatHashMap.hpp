@@ -0,0 +1,150 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+//------------------------------
+// Хеш-таблица с открытой адресацией и линейным пробированием.
+// Ключи и значения лежат в одном массиве, рядом - байт-метка на ячейку
+// (7 бит хеша), так что поиск почти не трогает чужие ключи.
+// Удаление только пакетное (eraseIf перестраивает таблицу), поэтому
+// надгробия не нужны. Поиск гетерогенный: find("x") для ключа std::string
+// не создаёт временную строку, если Hash и KeyEqual прозрачны
+//------------------------------
+template<class K, class V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<>>
+class FlatHashMap {
+    struct Slot {
+        K key{};
+        V value{};
+    };
+
+    static constexpr size_t kMinCapacity = 16;
+
+    std::vector<uint8_t> tags;  // 0 - пусто, иначе 0x80 | старшие 7 бит хеша
+    std::vector<Slot> slots;
+    size_t count = 0;
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] KeyEqual equal;
+
+    // Перемешивание: std::hash<int> - тождественная функция
+    template<class Q>
+    uint64_t hashOf(const Q& key) const {
+        uint64_t h = hasher(key);
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 32;
+        return h;
+    }
+
+    static uint8_t tagOf(uint64_t h) {
+        return static_cast<uint8_t>(0x80 | (h >> 57));
+    }
+
+    // Ячейка с ключом или первая пустая ячейка на пути пробирования
+    template<class Q>
+    size_t probe(const Q& key, uint64_t h) const {
+        const size_t mask = slots.size() - 1;
+        const uint8_t tag = tagOf(h);
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            if (tags[i] == 0 || (tags[i] == tag && equal(slots[i].key, key))) return i;
+        }
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<uint8_t> oldTags(capacity, 0);
+        std::vector<Slot> oldSlots(capacity);
+        oldTags.swap(tags);
+        oldSlots.swap(slots);
+        for (size_t i = 0; i < oldSlots.size(); ++i) {
+            if (!oldTags[i]) continue;
+            uint64_t h = hashOf(oldSlots[i].key);
+            size_t j = probe(oldSlots[i].key, h);
+            tags[j] = tagOf(h);
+            slots[j] = std::move(oldSlots[i]);
+        }
+    }
+
+    // Заполнение не выше 3/4
+    static size_t capacityFor(size_t n) {
+        size_t capacity = kMinCapacity;
+        while (capacity * 3 < n * 4) capacity *= 2;
+        return capacity;
+    }
+
+public:
+    FlatHashMap() : tags(kMinCapacity, 0), slots(kMinCapacity) {}
+
+    template<class Q>
+    V* find(const Q& key) {
+        size_t i = probe(key, hashOf(key));
+        return tags[i] ? &slots[i].value : nullptr;
+    }
+
+    template<class Q>
+    const V* find(const Q& key) const {
+        size_t i = probe(key, hashOf(key));
+        return tags[i] ? &slots[i].value : nullptr;
+    }
+
+    // Значение по ключу; если ключа нет, вставляет K(key) с V{}.
+    // Второй элемент - была ли вставка. Указатель живёт до следующей вставки
+    template<class Q>
+    std::pair<V*, bool> tryEmplace(const Q& key) {
+        uint64_t h = hashOf(key);
+        size_t i = probe(key, h);
+        if (tags[i]) return {&slots[i].value, false};
+        if ((count + 1) * 4 > slots.size() * 3) {
+            rehash(slots.size() * 2);
+            i = probe(key, h);
+        }
+        tags[i] = tagOf(h);
+        slots[i].key = K(key);
+        ++count;
+        return {&slots[i].value, true};
+    }
+
+    V& operator[](const K& key) {
+        return *tryEmplace(key).first;
+    }
+
+    // Удаляет все пары, для которых pred(key, value) истинно, за один проход
+    // с перестройкой таблицы. Возвращает число удалённых
+    template<class Pred>
+    size_t eraseIf(Pred pred) {
+        std::vector<Slot> kept;
+        kept.reserve(count);
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (tags[i] && !pred(std::as_const(slots[i].key), slots[i].value)) kept.push_back(std::move(slots[i]));
+        }
+        size_t removed = count - kept.size();
+        tags.assign(capacityFor(kept.size()), 0);
+        slots.assign(tags.size(), Slot{});
+        count = kept.size();
+        for (Slot& slot : kept) {
+            uint64_t h = hashOf(slot.key);
+            size_t j = probe(slot.key, h);
+            tags[j] = tagOf(h);
+            slots[j] = std::move(slot);
+        }
+        return removed;
+    }
+
+    template<class F>
+    void forEach(F f) const {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (tags[i]) f(slots[i].key, slots[i].value);
+        }
+    }
+
+    void reserve(size_t n) {
+        if (capacityFor(n) > slots.size()) rehash(capacityFor(n));
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+};
+
+#endif //FLATHASHMAP_H
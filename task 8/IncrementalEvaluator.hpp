@@ -0,0 +1,161 @@
+#ifndef INCREMENTALEVALUATOR_H
+#define INCREMENTALEVALUATOR_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Expression.hpp"
+
+//------------------------------
+// Инкрементальное вычисление набора выражений (DAG с общими подвыражениями).
+// Значение каждого узла хранится; у узла есть список родителей, так что
+// после set(x, v) пересчитываются только узлы на путях от x к корням -
+// и только пока значение действительно меняется. Узлы обходятся по
+// возрастанию высоты, поэтому каждый затронутый узел считается один раз,
+// уже после всех своих операндов
+//------------------------------
+class IncrementalEvaluator {
+    struct Node {
+        ExprKind kind;
+        uint32_t lhs = 0, rhs = 0;  // Индексы операндов
+        uint32_t height = 0;        // Листья - 0, узел - 1 + max(операнды)
+        int value = 0;
+        bool failed = false;        // Деление на ноль в узле или в операндах
+        bool queued = false;
+        std::vector<uint32_t> parents;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> roots;
+    std::vector<ExprPtr> owned;  // Держат узлы живыми: их адреса - ключи index
+    std::unordered_map<const Expression*, uint32_t> index;
+    // Один узел на имя: разные объекты Variable с одним именем (без фабрики)
+    // сходятся в нём, иначе set() обновил бы только один из них
+    std::unordered_map<std::string, uint32_t> variableNode;
+    std::map<std::string, int> context;
+    std::vector<std::vector<uint32_t>> buckets;  // Очередь пересчёта по высоте
+    size_t lastRecomputed = 0;
+
+    // Значение узла по операндам; семантика операций - ValueTraits<int>,
+    // как у остальных движков. Деление на ноль помечает узел, а не бросает
+    void recompute(Node& n) {
+        using T = ValueTraits<int>;
+        const Node& l = nodes[n.lhs];
+        const Node& r = nodes[n.rhs];
+        n.failed = l.failed || r.failed;
+        switch (n.kind) {
+            case ExprKind::Add: n.value = T::add(l.value, r.value); break;
+            case ExprKind::Subtract: n.value = T::subtract(l.value, r.value); break;
+            case ExprKind::Multiply: n.value = T::multiply(l.value, r.value); break;
+            default:
+                try {
+                    n.value = T::divide(l.value, r.value);
+                } catch (const std::logic_error&) {
+                    n.failed = true;
+                    n.value = 0;
+                }
+        }
+    }
+
+    uint32_t add(const Expression& e) {
+        if (auto it = index.find(&e); it != index.end()) return it->second;
+        Node n;
+        n.kind = e.kind();
+        switch (e.kind()) {
+            case ExprKind::Constant:
+                n.value = static_cast<const Constant&>(e).getValue();
+                break;
+            case ExprKind::Variable: {
+                const std::string& name = static_cast<const Variable&>(e).getName();
+                if (auto known = variableNode.find(name); known != variableNode.end()) {
+                    index.emplace(&e, known->second);
+                    return known->second;
+                }
+                auto it = context.find(name);
+                if (it == context.end()) throw std::logic_error("Variable " + name + " does not exist!");
+                n.value = it->second;
+                break;
+            }
+            default: {
+                auto& bin = static_cast<const BinaryOp&>(e);
+                n.lhs = add(*bin.getLeft());
+                n.rhs = add(*bin.getRight());
+                n.height = 1 + std::max(nodes[n.lhs].height, nodes[n.rhs].height);
+                recompute(n);
+            }
+        }
+        auto id = static_cast<uint32_t>(nodes.size());
+        if (e.kind() != ExprKind::Constant && e.kind() != ExprKind::Variable) {
+            nodes[n.lhs].parents.push_back(id);
+            if (n.rhs != n.lhs) nodes[n.rhs].parents.push_back(id);
+        }
+        if (e.kind() == ExprKind::Variable) variableNode.emplace(static_cast<const Variable&>(e).getName(), id);
+        nodes.push_back(std::move(n));
+        index.emplace(&e, id);
+        return id;
+    }
+
+    void enqueueParents(const Node& n) {
+        for (uint32_t p : n.parents) {
+            Node& parent = nodes[p];
+            if (parent.queued) continue;
+            parent.queued = true;
+            if (buckets.size() <= parent.height) buckets.resize(parent.height + 1);
+            buckets[parent.height].push_back(p);
+        }
+    }
+
+public:
+    explicit IncrementalEvaluator(std::map<std::string, int> initial = {}) : context(std::move(initial)) {}
+
+    // Добавляет выражение и возвращает его номер. Все переменные выражения
+    // должны быть в контексте; общие с уже добавленными узлы переиспользуются
+    size_t addRoot(const ExprPtr& e) {
+        owned.push_back(e);
+        roots.push_back(add(*e));
+        return roots.size() - 1;
+    }
+
+    // Меняет значение переменной и пересчитывает зависящие от неё узлы.
+    // Возвращает число пересчитанных узлов
+    size_t set(const std::string& name, int value) {
+        context[name] = value;
+        lastRecomputed = 0;
+        auto it = variableNode.find(name);
+        if (it == variableNode.end() || nodes[it->second].value == value) return 0;
+
+        nodes[it->second].value = value;
+        enqueueParents(nodes[it->second]);
+        for (size_t h = 1; h < buckets.size(); ++h) {
+            // Пересчёт узла высоты h добавляет только узлы большей высоты
+            for (size_t i = 0; i < buckets[h].size(); ++i) {
+                Node& n = nodes[buckets[h][i]];
+                n.queued = false;
+                int oldValue = n.value;
+                bool oldFailed = n.failed;
+                recompute(n);
+                ++lastRecomputed;
+                if (n.value != oldValue || n.failed != oldFailed) enqueueParents(n);
+            }
+            buckets[h].clear();
+        }
+        return lastRecomputed;
+    }
+
+    // Текущее значение выражения; при делении на ноль - то же исключение, что у evaluate
+    int value(size_t root) const {
+        const Node& n = nodes.at(roots.at(root));
+        if (n.failed) throw std::logic_error("Division by zero!");
+        return n.value;
+    }
+
+    const std::map<std::string, int>& variables() const { return context; }
+
+    size_t rootCount() const { return roots.size(); }
+    size_t nodeCount() const { return nodes.size(); }
+    size_t recomputedByLastSet() const { return lastRecomputed; }
+};
+
+#endif //INCREMENTALEVALUATOR_H
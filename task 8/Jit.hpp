@@ -0,0 +1,295 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Expression.hpp"
+#include "VariableLayout.hpp"
+#include "Bytecode.hpp"
+#include "RangeAnalysis.hpp"
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define TASK8_NATIVE_JIT 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//------------------------------
+// JIT-компиляция выражения в машинный код x86-64.
+// Код пишется в анонимную страницу, которая после записи становится
+// исполняемой (и перестаёт быть доступной на запись). Функция имеет вид
+//     int f(const int* slots, int* status)   // System V: rdi, rsi
+// результат - в eax, переменная - [rdi + 4 * слот]. Деление на ноль
+// уходит на общий участок ошибки: он пишет 1 в *status и возвращается,
+// а run() превращает это в то же исключение, что и evaluate.
+// На других архитектурах (или если страницу не удалось сделать исполняемой)
+// run() выполняет байткод того же выражения
+//------------------------------
+class JitExpression {
+    using NativeFunction = int (*)(const int* slots, int* status);
+
+    BytecodeProgram fallback;
+    NativeFunction native = nullptr;
+    void* page = nullptr;
+    size_t pageBytes = 0;
+    size_t codeBytes = 0;
+
+#ifdef TASK8_NATIVE_JIT
+    // Генератор кода. Значение узла всегда получается в eax; левый операнд
+    // общего вида сохраняется на машинном стеке (push/pop), общий узел DAG -
+    // в ячейке кадра [rbp - 8 * (k + 1)]
+    class Assembler {
+        std::vector<uint8_t> code;
+        std::vector<size_t> faultJumps;  // Поля rel32 переходов на участок ошибки
+        const VariableLayout& layout;
+        std::unordered_map<const Expression*, size_t> parents;
+        std::unordered_map<const Expression*, int32_t> frameSlot;
+        int32_t frameSlots = 0;
+        const RangeAnalysis* ranges;  // Доказанно безопасные деления - без проверок
+
+        void bytes(std::initializer_list<uint8_t> b) { code.insert(code.end(), b); }
+
+        void imm32(int32_t v) {
+            uint8_t b[4];
+            std::memcpy(b, &v, 4);
+            code.insert(code.end(), b, b + 4);
+        }
+
+        int32_t slotOffset(const Expression& variable) const {
+            return static_cast<int32_t>(4 * layout.slotOf(static_cast<const Variable&>(variable).getName()));
+        }
+
+        // Делимое в eax, делитель в ecx
+        void guardedDivide() {
+            bytes({0x85, 0xC9});              // test ecx, ecx
+            bytes({0x0F, 0x84});              // jz fault
+            faultJumps.push_back(code.size());
+            imm32(0);
+            // INT_MIN / -1 аппаратно бросает #DE; x / -1 считается как -x
+            bytes({0x83, 0xF9, 0xFF});        // cmp ecx, -1
+            bytes({0x75, 0x04});              // jne divide
+            bytes({0xF7, 0xD8});              // neg eax
+            bytes({0xEB, 0x03});              // jmp done
+            bytes({0x99});                    // divide: cdq
+            bytes({0xF7, 0xF9});              // idiv ecx
+        }
+
+        // Делимое в eax, делитель в ecx; проверки исключил RangeAnalysis
+        void divide(const Expression& node) {
+            if (ranges && ranges->divisionIsSafe(node)) {
+                bytes({0x99, 0xF7, 0xF9});    // cdq; idiv ecx
+            } else {
+                guardedDivide();
+            }
+        }
+
+        void countParents(const Expression& e) {
+            if (parents[&e]++ > 0 || e.kind() == ExprKind::Constant || e.kind() == ExprKind::Variable) return;
+            auto& bin = static_cast<const BinaryOp&>(e);
+            countParents(*bin.getLeft());
+            countParents(*bin.getRight());
+        }
+
+        void emit(const Expression& e) {
+            if (e.kind() == ExprKind::Constant) {
+                bytes({0xB8});                                  // mov eax, imm32
+                imm32(static_cast<const Constant&>(e).getValue());
+                return;
+            }
+            if (e.kind() == ExprKind::Variable) {
+                bytes({0x8B, 0x87});                            // mov eax, [rdi + disp32]
+                imm32(slotOffset(e));
+                return;
+            }
+
+            const bool shared = parents[&e] > 1;
+            if (shared) {
+                if (auto it = frameSlot.find(&e); it != frameSlot.end()) {
+                    bytes({0x8B, 0x85});                        // mov eax, [rbp + disp32]
+                    imm32(it->second);
+                    return;
+                }
+            }
+
+            auto& bin = static_cast<const BinaryOp&>(e);
+            const Expression& rhs = *bin.getRight();
+            const ExprKind kind = e.kind();
+            int rhsConstant = rhs.kind() == ExprKind::Constant ? static_cast<const Constant&>(rhs).getValue() : 0;
+
+            const bool safe = kind == ExprKind::IntegerDivide && ranges && ranges->divisionIsSafe(e);
+            if (rhs.kind() == ExprKind::Constant && (kind != ExprKind::IntegerDivide || (rhsConstant != 0 && (rhsConstant != -1 || safe)))) {
+                emit(*bin.getLeft());
+                switch (kind) {
+                    case ExprKind::Add: bytes({0x05}); break;            // add eax, imm32
+                    case ExprKind::Subtract: bytes({0x2D}); break;       // sub eax, imm32
+                    case ExprKind::Multiply: bytes({0x69, 0xC0}); break; // imul eax, eax, imm32
+                    default:
+                        bytes({0xB9});                                   // mov ecx, imm32
+                        imm32(rhsConstant);
+                        bytes({0x99, 0xF7, 0xF9});                       // cdq; idiv ecx
+                        break;
+                }
+                if (kind != ExprKind::IntegerDivide) imm32(rhsConstant);
+            } else if (rhs.kind() == ExprKind::Variable) {
+                emit(*bin.getLeft());
+                switch (kind) {
+                    case ExprKind::Add: bytes({0x03, 0x87}); break;            // add eax, [rdi + disp32]
+                    case ExprKind::Subtract: bytes({0x2B, 0x87}); break;       // sub eax, [rdi + disp32]
+                    case ExprKind::Multiply: bytes({0x0F, 0xAF, 0x87}); break; // imul eax, [rdi + disp32]
+                    default: bytes({0x8B, 0x8F}); break;                       // mov ecx, [rdi + disp32]
+                }
+                imm32(slotOffset(rhs));
+                if (kind == ExprKind::IntegerDivide) divide(e);
+            } else {
+                // Правый операнд вычисляется первым, как в IntegerDivide::evaluate
+                emit(rhs);
+                bytes({0x50});                      // push rax
+                emit(*bin.getLeft());
+                bytes({0x59});                      // pop rcx
+                switch (kind) {
+                    case ExprKind::Add: bytes({0x01, 0xC8}); break;            // add eax, ecx
+                    case ExprKind::Subtract: bytes({0x29, 0xC8}); break;       // sub eax, ecx
+                    case ExprKind::Multiply: bytes({0x0F, 0xAF, 0xC1}); break; // imul eax, ecx
+                    default: divide(e); break;
+                }
+            }
+
+            if (shared) {
+                int32_t offset = -8 * ++frameSlots;
+                bytes({0x89, 0x85});                // mov [rbp + disp32], eax
+                imm32(offset);
+                frameSlot.emplace(&e, offset);
+            }
+        }
+
+    public:
+        Assembler(const VariableLayout& l, const RangeAnalysis* r) : layout(l), ranges(r) {}
+
+        std::vector<uint8_t> compile(const Expression& e) {
+            countParents(e);
+            bytes({0x55});                          // push rbp
+            bytes({0x48, 0x89, 0xE5});              // mov rbp, rsp
+            size_t frameSize = code.size() + 3;     // Поле imm32 в sub rsp, imm32
+            bytes({0x48, 0x81, 0xEC});              // sub rsp, imm32
+            imm32(0);
+            emit(e);
+            bytes({0x48, 0x89, 0xEC});              // mov rsp, rbp
+            bytes({0x5D, 0xC3});                    // pop rbp; ret
+
+            int32_t frame = (frameSlots * 8 + 15) & ~15;
+            std::memcpy(code.data() + frameSize, &frame, 4);
+
+            // Участок ошибки: *status = 1, выход с любой глубины стека
+            auto fault = static_cast<int32_t>(code.size());
+            bytes({0xC7, 0x06});                    // mov dword [rsi], 1
+            imm32(1);
+            bytes({0x31, 0xC0});                    // xor eax, eax
+            bytes({0x48, 0x89, 0xEC});              // mov rsp, rbp
+            bytes({0x5D, 0xC3});                    // pop rbp; ret
+            for (size_t at : faultJumps) {
+                int32_t rel = fault - static_cast<int32_t>(at + 4);
+                std::memcpy(code.data() + at, &rel, 4);
+            }
+            return std::move(code);
+        }
+    };
+
+    void install(const std::vector<uint8_t>& code) {
+        size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t bytes = (code.size() + pageSize - 1) / pageSize * pageSize;
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return;
+        std::memcpy(p, code.data(), code.size());
+        if (mprotect(p, bytes, PROT_READ | PROT_EXEC) != 0) {
+            munmap(p, bytes);
+            return;
+        }
+        page = p;
+        pageBytes = bytes;
+        codeBytes = code.size();
+        native = reinterpret_cast<NativeFunction>(p);
+    }
+#endif
+
+    void release() {
+#ifdef TASK8_NATIVE_JIT
+        if (page) munmap(page, pageBytes);
+#endif
+        page = nullptr;
+        native = nullptr;
+    }
+
+public:
+    // Связывание с раскладкой: неизвестная переменная - std::logic_error здесь же
+    JitExpression(const Expression& e, VariableLayout layout)
+        : fallback(BytecodeCompiler::compile(e, std::move(layout))) {
+#ifdef TASK8_NATIVE_JIT
+        install(Assembler(fallback.layout(), nullptr).compile(e));
+#endif
+    }
+
+    // С интервальным анализом того же выражения: доказанно безопасные деления
+    // - голый idiv, без проверок делителя (и в байткоде запасного пути тоже)
+    JitExpression(const Expression& e, VariableLayout layout, const RangeAnalysis& ranges)
+        : fallback(BytecodeCompiler::compile(e, std::move(layout), ranges)) {
+#ifdef TASK8_NATIVE_JIT
+        install(Assembler(fallback.layout(), &ranges).compile(e));
+#endif
+    }
+
+    explicit JitExpression(const Expression& e) : JitExpression(e, VariableLayout::of(e)) {}
+
+    JitExpression(const JitExpression&) = delete;
+    JitExpression& operator=(const JitExpression&) = delete;
+
+    JitExpression(JitExpression&& other) noexcept
+        : fallback(std::move(other.fallback)), native(other.native), page(other.page),
+          pageBytes(other.pageBytes), codeBytes(other.codeBytes) {
+        other.page = nullptr;
+        other.native = nullptr;
+    }
+
+    JitExpression& operator=(JitExpression&& other) noexcept {
+        if (this != &other) {
+            release();
+            fallback = std::move(other.fallback);
+            native = std::exchange(other.native, nullptr);
+            page = std::exchange(other.page, nullptr);
+            pageBytes = other.pageBytes;
+            codeBytes = other.codeBytes;
+        }
+        return *this;
+    }
+
+    ~JitExpression() { release(); }
+
+    // Вычисление по контексту, разложенному по слотам layout()
+    int run(std::span<const int> slots) const {
+        if (!native) return fallback.run(slots);
+        if (slots.size() < fallback.layout().size()) {
+            throw std::logic_error("Context has fewer slots than the layout");
+        }
+        int status = 0;
+        int result = native(slots.data(), &status);
+        if (status) throw std::logic_error("Division by zero!");
+        return result;
+    }
+
+    int evaluate(const std::map<std::string, int>& vars) const {
+        return run(fallback.layout().makeContext(vars));
+    }
+
+    // Исполняется ли машинный код (иначе - байткод)
+    bool isNative() const { return native != nullptr; }
+
+    // Размер машинного кода в байтах (0 без JIT)
+    size_t codeSize() const { return native ? codeBytes : 0; }
+
+    const VariableLayout& layout() const { return fallback.layout(); }
+};
+
+#endif //JIT_H
@@ -0,0 +1,197 @@
+#ifndef MEMOCACHE_H
+#define MEMOCACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "Bytecode.hpp"
+#include "VariableLayout.hpp"
+
+//------------------------------
+// Выражение с ограниченным кешем результатов. Ключ - значения только тех
+// переменных, которые выражение читает (слоты layout()), отпечаток - 64-битный
+// хеш этих значений; полный ключ хранится рядом и сравнивается, так что
+// коллизия отпечатков не даёт чужой результат. Деление на ноль тоже кешируется
+// и на попадании бросает то же исключение.
+// Вытеснение - CLOCK: у записи бит обращения, стрелка обходит записи по кругу,
+// сбрасывает биты и вытесняет первую запись без бита.
+// evaluate можно вызывать из нескольких потоков: поиск идёт под разделяемой
+// блокировкой (бит обращения и счётчики атомарны), вставка после промаха -
+// под исключительной
+//------------------------------
+class MemoizedExpression {
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    struct Entry {
+        uint64_t hash = 0;
+        int value = 0;
+        bool faulted = false;
+        mutable std::atomic<uint8_t> referenced{0};
+    };
+
+    BytecodeProgram program;
+    size_t width;                    // Число переменных в ключе
+    size_t capacity_;
+    std::vector<Entry> entries;
+    std::vector<int> keys;           // Ключ записи i - keys[i * width ...]
+    std::vector<uint32_t> index;     // Открытая адресация: номера записей
+    size_t mask;
+    size_t used = 0;                 // Заполненных записей (до capacity_)
+    size_t hand = 0;                 // Стрелка CLOCK
+    mutable std::shared_mutex mutex;
+    std::atomic<uint64_t> hits_{0}, misses_{0};
+
+    static uint64_t fingerprint(const int* values, size_t n) {
+        uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+        for (size_t i = 0; i < n; ++i) {
+            h ^= static_cast<uint32_t>(values[i]);
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 32;
+        }
+        return h;
+    }
+
+    bool sameKey(uint32_t entry, const int* values) const {
+        const int* key = keys.data() + entry * width;
+        for (size_t i = 0; i < width; ++i) {
+            if (key[i] != values[i]) return false;
+        }
+        return true;
+    }
+
+    // Ячейка индекса с записью ключа или kEmpty-ячейка, где поиск остановился
+    size_t probe(uint64_t h, const int* values) const {
+        size_t p = h & mask;
+        while (index[p] != kEmpty && !(entries[index[p]].hash == h && sameKey(index[p], values))) {
+            p = (p + 1) & mask;
+        }
+        return p;
+    }
+
+    // Удаление из индекса со сдвигом назад: надгробия не нужны
+    void unindex(uint32_t entry) {
+        size_t i = entries[entry].hash & mask;
+        while (index[i] != entry) i = (i + 1) & mask;
+        for (size_t j = (i + 1) & mask; index[j] != kEmpty; j = (j + 1) & mask) {
+            size_t home = entries[index[j]].hash & mask;
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                index[i] = index[j];
+                i = j;
+            }
+        }
+        index[i] = kEmpty;
+    }
+
+    // Запись под новый ключ: свободная или вытесненная по CLOCK
+    uint32_t victim() {
+        if (used < capacity_) return static_cast<uint32_t>(used++);
+        for (;; hand = (hand + 1) % capacity_) {
+            Entry& e = entries[hand];
+            if (e.referenced.load(std::memory_order_relaxed)) {
+                e.referenced.store(0, std::memory_order_relaxed);
+                continue;
+            }
+            auto chosen = static_cast<uint32_t>(hand);
+            hand = (hand + 1) % capacity_;
+            unindex(chosen);
+            return chosen;
+        }
+    }
+
+    int lookupOrCompute(const int* values) {
+        uint64_t h = fingerprint(values, width);
+        {
+            std::shared_lock lock(mutex);
+            size_t p = probe(h, values);
+            if (index[p] != kEmpty) {
+                const Entry& e = entries[index[p]];
+                e.referenced.store(1, std::memory_order_relaxed);
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                if (e.faulted) throw std::logic_error("Division by zero!");
+                return e.value;
+            }
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+
+        // Вычисление - вне блокировки; вставляет тот, кто успел первым
+        int value;
+        try {
+            value = program.run(std::span<const int>(values, width));
+        } catch (const std::logic_error&) {
+            insert(h, values, 0, true);
+            throw;
+        }
+        insert(h, values, value, false);
+        return value;
+    }
+
+    void insert(uint64_t h, const int* values, int value, bool faulted) {
+        std::unique_lock lock(mutex);
+        if (index[probe(h, values)] != kEmpty) return;
+        uint32_t id = victim();
+        Entry& e = entries[id];
+        e.hash = h;
+        e.value = value;
+        e.faulted = faulted;
+        e.referenced.store(0, std::memory_order_relaxed);
+        std::copy_n(values, width, keys.data() + id * width);
+        index[probe(h, values)] = id;
+    }
+
+public:
+    // capacity - максимум записей; индекс занят не больше чем наполовину
+    MemoizedExpression(const Expression& e, size_t capacity)
+        : program(BytecodeCompiler::compile(e)), width(program.layout().size()),
+          capacity_(std::max<size_t>(capacity, 1)), entries(capacity_), keys(capacity_ * width),
+          index(std::bit_ceil(2 * capacity_), kEmpty), mask(index.size() - 1) {}
+
+    MemoizedExpression(const ExprPtr& e, size_t capacity) : MemoizedExpression(*e, capacity) {}
+
+    // Значения переменных по слотам layout() - это и есть ключ кеша
+    int evaluate(std::span<const int> slots) {
+        if (slots.size() < width) throw std::logic_error("Context has fewer slots than the layout");
+        return lookupOrCompute(slots.data());
+    }
+
+    // Из словаря берутся только переменные выражения
+    int evaluate(const std::map<std::string, int>& vars) {
+        constexpr size_t kInline = 16;
+        if (width > kInline) return evaluate(program.layout().makeContext(vars));
+        int values[kInline];
+        const auto& names = program.layout().variables();
+        for (size_t i = 0; i < width; ++i) {
+            auto it = vars.find(names[i]);
+            if (it == vars.end()) throw std::logic_error("Variable " + names[i] + " does not exist!");
+            values[i] = it->second;
+        }
+        return lookupOrCompute(values);
+    }
+
+    void clear() {
+        std::unique_lock lock(mutex);
+        std::fill(index.begin(), index.end(), kEmpty);
+        used = 0;
+        hand = 0;
+    }
+
+    // Переменные, которые читает выражение, в порядке слотов ключа
+    const VariableLayout& layout() const { return program.layout(); }
+    size_t capacity() const { return capacity_; }
+
+    size_t size() const {
+        std::shared_lock lock(mutex);
+        return used;
+    }
+
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+};
+
+#endif //MEMOCACHE_H
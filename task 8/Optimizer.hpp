@@ -0,0 +1,176 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <climits>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include "ExpressionFactory.hpp"
+
+//------------------------------
+// Оптимизация выражения: свёртка константных поддеревьев, алгебраические
+// тождества и канонический порядок операндов у Add / Multiply.
+// Результат строится через ExpressionFactory, поэтому это DAG, в котором
+// одинаковые после упрощения подвыражения снова сливаются в один узел.
+//
+// Упрощение сохраняет значение и ошибки деления на ноль: подвыражение,
+// которое может бросить исключение, не выбрасывается (x * 0 остаётся,
+// если в x есть деление на неконстанту). Переменные считаются заданными:
+// их отсутствие - ошибка связывания (см. VariableLayout), а не вычисления
+//------------------------------
+class ExpressionOptimizer {
+public:
+    struct Result {
+        ExprPtr expr;
+        size_t nodesBefore;  // Различных узлов в DAG до
+        size_t nodesAfter;   // и после оптимизации
+
+        size_t eliminated() const {
+            return nodesBefore > nodesAfter ? nodesBefore - nodesAfter : 0;
+        }
+    };
+
+    static Result optimize(const ExprPtr& e) {
+        ExpressionOptimizer optimizer;
+        size_t before = countNodes(e);
+        ExprPtr result = optimizer.rewrite(e);
+        return {result, before, countNodes(result)};
+    }
+
+    // Число различных узлов, достижимых из e
+    static size_t countNodes(const ExprPtr& e) {
+        std::unordered_set<const Expression*> seen;
+        std::function<void(const Expression&)> visit = [&](const Expression& node) {
+            if (!seen.insert(&node).second) return;
+            if (node.kind() == ExprKind::Constant || node.kind() == ExprKind::Variable) return;
+            auto& bin = static_cast<const BinaryOp&>(node);
+            visit(*bin.getLeft());
+            visit(*bin.getRight());
+        };
+        visit(*e);
+        return seen.size();
+    }
+
+private:
+    ExpressionFactory& factory = ExpressionFactory::instance();
+    std::unordered_map<const Expression*, ExprPtr> rewritten;
+    std::unordered_map<const Expression*, bool> failing;
+    std::unordered_map<const Expression*, size_t> hashes;
+
+    static bool isConstant(const ExprPtr& e, int value) {
+        return e->kind() == ExprKind::Constant && static_cast<const Constant&>(*e).getValue() == value;
+    }
+
+    static int valueOf(const ExprPtr& e) {
+        return static_cast<const Constant&>(*e).getValue();
+    }
+
+    // Может ли вычисление бросить исключение (деление на не-константу или на 0)
+    bool mayFail(const ExprPtr& e) {
+        if (e->kind() == ExprKind::Constant || e->kind() == ExprKind::Variable) return false;
+        if (auto it = failing.find(e.get()); it != failing.end()) return it->second;
+        auto& bin = static_cast<const BinaryOp&>(*e);
+        bool result = mayFail(bin.getLeft()) || mayFail(bin.getRight())
+            || (e->kind() == ExprKind::IntegerDivide
+                && (bin.getRight()->kind() != ExprKind::Constant || valueOf(bin.getRight()) == 0));
+        failing.emplace(e.get(), result);
+        return result;
+    }
+
+    // Структурный хеш: не зависит от адресов, поэтому порядок операндов
+    // воспроизводим от запуска к запуску
+    size_t structuralHash(const ExprPtr& e) {
+        switch (e->kind()) {
+            case ExprKind::Constant: return std::hash<int>{}(valueOf(e));
+            case ExprKind::Variable: return std::hash<std::string>{}(static_cast<const Variable&>(*e).getName());
+            default: break;
+        }
+        if (auto it = hashes.find(e.get()); it != hashes.end()) return it->second;
+        auto& bin = static_cast<const BinaryOp&>(*e);
+        size_t h = structuralHash(bin.getLeft()) * 0x9e3779b97f4a7c15ull;
+        h = (h ^ structuralHash(bin.getRight())) * 31 + static_cast<size_t>(e->kind());
+        hashes.emplace(e.get(), h);
+        return h;
+    }
+
+    // Канонический порядок: константы, затем переменные по имени,
+    // затем составные узлы по структурному хешу
+    bool before(const ExprPtr& a, const ExprPtr& b) {
+        auto rank = [](const ExprPtr& e) {
+            return e->kind() == ExprKind::Constant ? 0 : e->kind() == ExprKind::Variable ? 1 : 2;
+        };
+        if (rank(a) != rank(b)) return rank(a) < rank(b);
+        switch (rank(a)) {
+            case 0: return valueOf(a) < valueOf(b);
+            case 1: return static_cast<const Variable&>(*a).getName() < static_cast<const Variable&>(*b).getName();
+            default: {
+                size_t ha = structuralHash(a), hb = structuralHash(b);
+                return ha != hb ? ha < hb : a.get() < b.get();
+            }
+        }
+    }
+
+    // Свёртка в unsigned: переполнение заворачивается, как при вычислении
+    static std::optional<int> fold(ExprKind kind, int l, int r) {
+        auto ul = static_cast<unsigned>(l), ur = static_cast<unsigned>(r);
+        switch (kind) {
+            case ExprKind::Add: return static_cast<int>(ul + ur);
+            case ExprKind::Subtract: return static_cast<int>(ul - ur);
+            case ExprKind::Multiply: return static_cast<int>(ul * ur);
+            default:
+                // Деление на ноль (и INT_MIN / -1) оставляем вычислению
+                if (r == 0 || (l == INT_MIN && r == -1)) return std::nullopt;
+                return l / r;
+        }
+    }
+
+    ExprPtr simplify(ExprKind kind, ExprPtr l, ExprPtr r) {
+        if (l->kind() == ExprKind::Constant && r->kind() == ExprKind::Constant) {
+            if (auto v = fold(kind, valueOf(l), valueOf(r))) return factory.getConstant(*v);
+        }
+
+        switch (kind) {
+            case ExprKind::Add:
+            case ExprKind::Multiply: {
+                if (before(r, l)) std::swap(l, r);
+                const int identity = kind == ExprKind::Add ? 0 : 1;
+                if (isConstant(l, identity)) return r;  // 0 + x, 1 * x
+                if (kind == ExprKind::Multiply && isConstant(l, 0) && !mayFail(r)) return l;  // 0 * x
+                // c1 op (c2 op x) -> (c1 op c2) op x
+                if (l->kind() == ExprKind::Constant && r->kind() == kind) {
+                    auto& inner = static_cast<const BinaryOp&>(*r);
+                    if (inner.getLeft()->kind() == ExprKind::Constant) {
+                        return simplify(kind, factory.getConstant(*fold(kind, valueOf(l), valueOf(inner.getLeft()))),
+                                        inner.getRight());
+                    }
+                }
+                break;
+            }
+            case ExprKind::Subtract:
+                if (isConstant(r, 0)) return l;                         // x - 0
+                if (l == r && !mayFail(l)) return factory.getConstant(0);  // x - x
+                break;
+            default:
+                if (isConstant(r, 1)) return l;                         // x // 1
+                break;
+        }
+        return factory.getBinary(kind, std::move(l), std::move(r));
+    }
+
+    ExprPtr rewrite(const ExprPtr& e) {
+        if (e->kind() == ExprKind::Constant || e->kind() == ExprKind::Variable) {
+            // Листья переводятся в пул фабрики, чтобы равные листья совпали по адресу
+            return e->kind() == ExprKind::Constant
+                ? factory.getConstant(valueOf(e))
+                : factory.getVariable(static_cast<const Variable&>(*e).getId());
+        }
+        if (auto it = rewritten.find(e.get()); it != rewritten.end()) return it->second;
+        auto& bin = static_cast<const BinaryOp&>(*e);
+        ExprPtr result = simplify(e->kind(), rewrite(bin.getLeft()), rewrite(bin.getRight()));
+        rewritten.emplace(e.get(), result);
+        return result;
+    }
+};
+
+#endif //OPTIMIZER_H
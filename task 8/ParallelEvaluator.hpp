@@ -0,0 +1,90 @@
+#ifndef PARALLELEVALUATOR_H
+#define PARALLELEVALUATOR_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Bytecode.hpp"
+#include "WorkStealingPool.hpp"
+
+//------------------------------
+// Параллельное вычисление многих выражений на многих контекстах.
+// Работа (выражение x контекст) режется на плитки kExpressionTile x
+// kContextTile; плитки раздаются WorkStealingPool. Каждое выражение
+// скомпилировано в байткод заранее, у каждого потока свой буфер стека VM,
+// поэтому само вычисление ничего не выделяет. Результат выражения e на
+// контексте c всегда лежит в results[e * contexts + c], порядок не зависит
+// от того, какой поток что посчитал
+//------------------------------
+class ParallelEvaluator {
+public:
+    static constexpr size_t kExpressionTile = 16;
+    static constexpr size_t kContextTile = 256;
+
+private:
+    VariableLayout layout_;
+    std::vector<BytecodeProgram> programs;
+    WorkStealingPool pool;
+    std::vector<std::vector<int>> scratch;  // Буфер стека VM на поток
+
+public:
+    // Связывание всех выражений с одной раскладкой контекста
+    ParallelEvaluator(std::span<const ExprPtr> expressions, VariableLayout layout,
+                      size_t threads = std::thread::hardware_concurrency())
+        : layout_(std::move(layout)), pool(threads), scratch(pool.size()) {
+        programs.reserve(expressions.size());
+        for (const auto& e : expressions) programs.push_back(BytecodeCompiler::compile(e, layout_));
+    }
+
+    // contexts - контексты подряд, по layout().size() значений на каждый.
+    // failed[i] = 1, если results[i] не посчитан из-за деления на ноль.
+    // Возвращает число таких результатов
+    size_t evaluate(std::span<const int> contexts, std::span<int> results, std::span<uint8_t> failed) {
+        const size_t width = layout_.size();
+        if (width == 0) {
+            throw std::logic_error("Parallel evaluation: layout has no variables, pass the context count");
+        }
+        return evaluate(contexts, contexts.size() / width, results, failed);
+    }
+
+    // То же с явным числом контекстов: нужно, когда выражения не читают
+    // переменных (раскладка пуста и по contexts число контекстов не узнать)
+    size_t evaluate(std::span<const int> contexts, size_t contextCount, std::span<int> results, std::span<uint8_t> failed) {
+        const size_t width = layout_.size();
+        const size_t total = programs.size() * contextCount;
+        if (contexts.size() != contextCount * width || results.size() < total || failed.size() < total) {
+            throw std::logic_error("Parallel evaluation: wrong context or output size");
+        }
+
+        const size_t expressionTiles = (programs.size() + kExpressionTile - 1) / kExpressionTile;
+        const size_t contextTiles = (contextCount + kContextTile - 1) / kContextTile;
+        std::vector<size_t> failures(pool.size(), 0);
+        pool.parallelFor(expressionTiles * contextTiles, [&](size_t tile, size_t worker) {
+            const size_t e0 = tile / contextTiles * kExpressionTile;
+            const size_t c0 = tile % contextTiles * kContextTile;
+            const size_t e1 = std::min(e0 + kExpressionTile, programs.size());
+            const size_t c1 = std::min(c0 + kContextTile, contextCount);
+            auto& stack = scratch[worker];
+            size_t localFailures = 0;
+            for (size_t e = e0; e < e1; ++e) {
+                for (size_t c = c0; c < c1; ++c) {
+                    size_t at = e * contextCount + c;
+                    bool ok = programs[e].tryRun(contexts.subspan(c * width, width), stack, results[at]);
+                    failed[at] = !ok;
+                    localFailures += !ok;
+                }
+            }
+            failures[worker] += localFailures;
+        });
+
+        size_t sum = 0;
+        for (size_t f : failures) sum += f;
+        return sum;
+    }
+
+    const VariableLayout& layout() const { return layout_; }
+    size_t expressionCount() const { return programs.size(); }
+    size_t threads() const { return pool.size(); }
+};
+
+#endif //PARALLELEVALUATOR_H
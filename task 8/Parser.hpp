@@ -0,0 +1,123 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include "ExpressionFactory.hpp"
+
+//------------------------------
+// Разбор текстовых выражений (Pratt-парсер поверх std::string_view).
+// Синтаксис совпадает с выводом BinaryOp::print, так что parse(print(e))
+// даёт то же выражение, а для собранного через фабрику e - тот же узел:
+//   expr    := operand (op operand)*
+//   op      := '+' | '-' (приоритет 1) | '*' | '//' (приоритет 2), левоассоциативны
+//   operand := integer | identifier | '(' expr ')'
+// Отрицательная константа печатается как "-3" и разбирается так же:
+// минус в позиции операнда - знак числа. Токены - подстроки исходного
+// текста; имя переменной ищется в пуле фабрики без копирования строки.
+// Каждая скобка - уровень рекурсии, поэтому вложенность ограничена kMaxDepth:
+// более глубокий ввод - ошибка разбора, а не переполнение стека
+//------------------------------
+class ExpressionParser {
+public:
+    static constexpr size_t kMaxDepth = 10'000;
+
+private:
+    std::string_view text;
+    size_t pos = 0;
+    size_t depth = 0;  // Открытых скобок на текущем пути разбора
+    ExpressionFactory& factory = ExpressionFactory::instance();
+
+    explicit ExpressionParser(std::string_view source) : text(source) {}
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::logic_error("Parse error at position " + std::to_string(pos) + ": " + message);
+    }
+
+    void skipSpaces() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) ++pos;
+    }
+
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static bool isIdentifierStart(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    // Бинарная операция на текущей позиции (без сдвига); приоритет 0 - не операция
+    int peekOperator(ExprKind& kind, size_t& length) const {
+        if (pos >= text.size()) return 0;
+        length = 1;
+        switch (text[pos]) {
+            case '+': kind = ExprKind::Add; return 1;
+            case '-': kind = ExprKind::Subtract; return 1;
+            case '*': kind = ExprKind::Multiply; return 2;
+            case '/':
+                if (pos + 1 < text.size() && text[pos + 1] == '/') {
+                    kind = ExprKind::IntegerDivide;
+                    length = 2;
+                    return 2;
+                }
+                return 0;
+            default: return 0;
+        }
+    }
+
+    ExprPtr parseOperand() {
+        skipSpaces();
+        if (pos >= text.size()) fail("unexpected end of input");
+        char c = text[pos];
+        if (c == '(') {
+            if (depth == kMaxDepth) fail("nesting deeper than " + std::to_string(kMaxDepth) + " levels");
+            ++pos;
+            ++depth;
+            ExprPtr inner = parseExpression(1);
+            skipSpaces();
+            if (pos >= text.size() || text[pos] != ')') fail("expected ')'");
+            ++pos;
+            --depth;
+            return inner;
+        }
+        if (isDigit(c) || (c == '-' && pos + 1 < text.size() && isDigit(text[pos + 1]))) {
+            int value = 0;
+            auto [end, error] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+            if (error != std::errc{}) fail("integer constant out of range");
+            pos = static_cast<size_t>(end - text.data());
+            return factory.getConstant(value);
+        }
+        if (isIdentifierStart(c)) {
+            size_t start = pos;
+            while (pos < text.size() && (isIdentifierStart(text[pos]) || isDigit(text[pos]))) ++pos;
+            return factory.getVariable(text.substr(start, pos - start));
+        }
+        fail(std::string("unexpected character '") + c + "'");
+    }
+
+    // Операнд и все следующие за ним операции с приоритетом не ниже minPrecedence
+    ExprPtr parseExpression(int minPrecedence) {
+        ExprPtr lhs = parseOperand();
+        for (;;) {
+            skipSpaces();
+            ExprKind kind{};
+            size_t length = 0;
+            int precedence = peekOperator(kind, length);
+            if (precedence < minPrecedence || precedence == 0) return lhs;
+            pos += length;
+            ExprPtr rhs = parseExpression(precedence + 1);
+            lhs = factory.getBinary(kind, std::move(lhs), std::move(rhs));
+        }
+    }
+
+public:
+    // Разбор выражения целиком; ошибка синтаксиса - std::logic_error с позицией
+    static ExprPtr parse(std::string_view source) {
+        ExpressionParser parser(source);
+        ExprPtr result = parser.parseExpression(1);
+        parser.skipSpaces();
+        if (parser.pos != source.size()) parser.fail("unexpected trailing input");
+        return result;
+    }
+};
+
+#endif //PARSER_H
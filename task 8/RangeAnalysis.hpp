@@ -0,0 +1,168 @@
+#ifndef RANGEANALYSIS_H
+#define RANGEANALYSIS_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Expression.hpp"
+
+// Отрезок значений [lo, hi] (включительно). Границы хранятся в int64_t,
+// чтобы точный результат операции над двумя int был представим
+struct Interval {
+    int64_t lo = INT_MIN;
+    int64_t hi = INT_MAX;
+
+    static Interval full() { return {}; }
+    static Interval point(int v) { return {v, v}; }
+
+    bool contains(int64_t v) const { return lo <= v && v <= hi; }
+    bool fitsInt() const { return lo >= INT_MIN && hi <= INT_MAX; }
+
+    friend bool operator==(const Interval&, const Interval&) = default;
+};
+
+// Границы переменных; переменная без границ может принимать любое значение int
+using VariableBounds = std::map<std::string, Interval>;
+
+//------------------------------
+// Интервальный анализ выражения: для каждого узла - отрезок, в котором
+// гарантированно лежит его значение, если переменные лежат в своих границах.
+// По нему компиляторы (байткод, пакетный, JIT) убирают проверки деления:
+// если делитель не может быть нулём, а пара INT_MIN // -1 невозможна,
+// деление выполняется без проверок. Гарантия действует, только пока входы
+// соблюдают границы: за их нарушение отвечает вызывающий
+//------------------------------
+class RangeAnalysis {
+    struct Info {
+        Interval range;
+        bool mayOverflow = false;   // Точный результат может не поместиться в int
+        bool zeroDivisor = false;   // Деление, делитель которого может быть нулём
+    };
+
+    std::unordered_map<const Expression*, Info> info;
+    std::vector<const Expression*> faults;  // Деления, делитель которых всегда ноль
+    Interval result_;
+    size_t divisions = 0, safeDivisions = 0, overflows = 0;
+
+    // Отрезок точного результата; не помещается в int - значение заворачивается,
+    // и о нём известно только, что это какой-то int
+    static Info wrap(int64_t lo, int64_t hi) {
+        Info r{{lo, hi}};
+        if (!r.range.fitsInt()) {
+            r.range = Interval::full();
+            r.mayOverflow = true;
+        }
+        return r;
+    }
+
+    // Частное с усечением к нулю монотонно по каждому аргументу, пока делитель
+    // одного знака, так что крайние значения - в углах прямоугольника
+    static void quotientCorners(Interval x, int64_t c, int64_t d, int64_t& lo, int64_t& hi) {
+        for (int64_t a : {x.lo, x.hi}) {
+            for (int64_t b : {c, d}) {
+                lo = std::min(lo, a / b);
+                hi = std::max(hi, a / b);
+            }
+        }
+    }
+
+    Info divide(const Expression& node, Interval x, Interval y) {
+        ++divisions;
+        int64_t lo = INT64_MAX, hi = INT64_MIN;
+        if (y.lo <= -1) quotientCorners(x, y.lo, std::min<int64_t>(y.hi, -1), lo, hi);
+        if (y.hi >= 1) quotientCorners(x, std::max<int64_t>(y.lo, 1), y.hi, lo, hi);
+        if (lo > hi) {
+            // Делитель всегда ноль: вычисление всегда бросает исключение
+            faults.push_back(&node);
+            Info r{Interval::point(0)};
+            r.zeroDivisor = true;
+            return r;
+        }
+        Info r = wrap(lo, hi);
+        r.zeroDivisor = y.contains(0);
+        if (!r.zeroDivisor && !r.mayOverflow) ++safeDivisions;
+        return r;
+    }
+
+    const Info& visit(const Expression& e, const VariableBounds& bounds) {
+        if (auto it = info.find(&e); it != info.end()) return it->second;
+        Info r;
+        switch (e.kind()) {
+            case ExprKind::Constant:
+                r.range = Interval::point(static_cast<const Constant&>(e).getValue());
+                break;
+            case ExprKind::Variable: {
+                auto it = bounds.find(static_cast<const Variable&>(e).getName());
+                if (it != bounds.end()) r.range = it->second;
+                break;
+            }
+            default: {
+                auto& bin = static_cast<const BinaryOp&>(e);
+                Interval x = visit(*bin.getLeft(), bounds).range;
+                Interval y = visit(*bin.getRight(), bounds).range;
+                switch (e.kind()) {
+                    case ExprKind::Add: r = wrap(x.lo + y.lo, x.hi + y.hi); break;
+                    case ExprKind::Subtract: r = wrap(x.lo - y.hi, x.hi - y.lo); break;
+                    case ExprKind::Multiply: {
+                        int64_t p[] = {x.lo * y.lo, x.lo * y.hi, x.hi * y.lo, x.hi * y.hi};
+                        r = wrap(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+                        break;
+                    }
+                    default: r = divide(e, x, y); break;
+                }
+                overflows += r.mayOverflow;
+            }
+        }
+        return info.emplace(&e, r).first->second;
+    }
+
+    const Info& at(const Expression& e) const {
+        auto it = info.find(&e);
+        if (it == info.end()) throw std::logic_error("Node is not part of the analysed expression");
+        return it->second;
+    }
+
+public:
+    explicit RangeAnalysis(const Expression& root, const VariableBounds& bounds = {}) {
+        for (const auto& [name, range] : bounds) {
+            if (range.lo > range.hi || !range.fitsInt()) {
+                throw std::logic_error("Invalid bounds for variable " + name);
+            }
+        }
+        result_ = visit(root, bounds).range;
+    }
+
+    // Отрезок значений узла (узел должен быть частью анализируемого выражения)
+    Interval range(const Expression& e) const { return at(e).range; }
+    Interval result() const { return result_; }
+
+    // Деление, которому не нужны проверки: делитель не ноль и не INT_MIN // -1
+    bool divisionIsSafe(const Expression& e) const {
+        const Info& i = at(e);
+        return e.kind() == ExprKind::IntegerDivide && !i.zeroDivisor && !i.mayOverflow;
+    }
+
+    // Переполнение возможно (для Checked<int> здесь нужна проверка)
+    bool mayOverflow(const Expression& e) const { return at(e).mayOverflow; }
+
+    // Может ли вычисление бросить исключение при каких-то входах в границах
+    bool mayFault() const {
+        return std::any_of(info.begin(), info.end(), [](const auto& p) { return p.second.zeroDivisor; });
+    }
+
+    // Деления на всегда нулевой делитель. Вычисляются все узлы выражения,
+    // так что непустой список значит: выражение бросает при любых входах
+    const std::vector<const Expression*>& definiteFaults() const { return faults; }
+    bool alwaysFaults() const { return !faults.empty(); }
+
+    size_t divisionCount() const { return divisions; }
+    size_t safeDivisionCount() const { return safeDivisions; }
+    size_t overflowCount() const { return overflows; }
+};
+
+#endif //RANGEANALYSIS_H
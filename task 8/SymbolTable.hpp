@@ -0,0 +1,128 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FlatHashMap.hpp"
+
+// Номер имени переменной в SymbolTable
+using SymbolId = uint32_t;
+
+//------------------------------
+// Глобальная таблица имён переменных (Singleton): каждое имя получает плотный
+// номер при первом intern и сохраняет его до конца программы (имена не
+// удаляются). Строка хешируется один раз - при разборе или построении узла,
+// дальше узлы и контексты работают с номерами.
+// Потокобезопасна: поиск под разделяемой блокировкой, вставка - под исключительной.
+// Ссылки, которые возвращает name(), не инвалидируются новыми именами
+//------------------------------
+class SymbolTable {
+    mutable std::shared_mutex mutex;
+    FlatHashMap<std::string, SymbolId, std::hash<std::string_view>> ids;
+    std::deque<std::string> names;
+
+    SymbolTable() = default;
+
+public:
+    static SymbolTable& instance() {
+        static SymbolTable table;
+        return table;
+    }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // Номер имени; новое имя получает следующий свободный номер
+    SymbolId intern(std::string_view name) {
+        {
+            std::shared_lock lock(mutex);
+            if (const SymbolId* id = ids.find(name)) return *id;
+        }
+        std::unique_lock lock(mutex);
+        auto [id, inserted] = ids.tryEmplace(name);
+        if (inserted) {
+            *id = static_cast<SymbolId>(names.size());
+            names.emplace_back(name);
+        }
+        return *id;
+    }
+
+    std::optional<SymbolId> find(std::string_view name) const {
+        std::shared_lock lock(mutex);
+        if (const SymbolId* id = ids.find(name)) return *id;
+        return std::nullopt;
+    }
+
+    const std::string& name(SymbolId id) const {
+        std::shared_lock lock(mutex);
+        if (id >= names.size()) throw std::logic_error("Unknown symbol id " + std::to_string(id));
+        return names[id];
+    }
+
+    size_t size() const {
+        std::shared_lock lock(mutex);
+        return names.size();
+    }
+};
+
+//------------------------------
+// Контекст переменных, индексируемый номером символа: значение переменной -
+// элемент вектора, без поиска по строке. Имена переводятся в номера один раз,
+// при заполнении контекста
+//------------------------------
+template<class V>
+class BasicSymbolContext {
+    std::vector<V> values;
+    std::vector<uint8_t> present;  // Задана ли переменная с этим номером
+
+public:
+    BasicSymbolContext() = default;
+
+    // Из словаря имя -> значение (не конструктор: иначе {{"x", 1}} в вызове
+    // evaluate стал бы неоднозначным)
+    static BasicSymbolContext from(const std::map<std::string, V>& vars) {
+        BasicSymbolContext context;
+        for (const auto& [name, value] : vars) context.set(name, value);
+        return context;
+    }
+
+    void set(SymbolId id, V value) {
+        if (id >= values.size()) {
+            values.resize(id + 1);
+            present.resize(id + 1);
+        }
+        values[id] = value;
+        present[id] = 1;
+    }
+
+    void set(std::string_view name, V value) {
+        set(SymbolTable::instance().intern(name), value);
+    }
+
+    void erase(SymbolId id) {
+        if (id < present.size()) present[id] = 0;
+    }
+
+    bool contains(SymbolId id) const {
+        return id < present.size() && present[id];
+    }
+
+    V get(SymbolId id) const {
+        if (!contains(id)) {
+            throw std::logic_error("Variable " + SymbolTable::instance().name(id) + " does not exist!");
+        }
+        return values[id];
+    }
+};
+
+using SymbolContext = BasicSymbolContext<int>;
+
+#endif //SYMBOLTABLE_H
@@ -0,0 +1,95 @@
+#ifndef VALUETRAITS_H
+#define VALUETRAITS_H
+
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+// Целое с проверкой переполнения: арифметика над Checked<T> бросает
+// std::overflow_error вместо заворачивания
+template<std::signed_integral T>
+struct Checked {
+    T value{};
+
+    constexpr Checked() = default;
+    constexpr Checked(T v) : value(v) {}
+
+    friend constexpr bool operator==(Checked, Checked) = default;
+
+    friend std::ostream& operator<<(std::ostream& os, Checked c) {
+        return os << c.value;
+    }
+};
+
+// Ядра вычисления для типа значения выражения. Выбираются при компиляции:
+// BasicAdd<V>::evaluate вызывает ValueTraits<V>::add напрямую.
+// Деление на ноль для всех типов - std::logic_error("Division by zero!")
+template<class V>
+struct ValueTraits;
+
+// Знаковые целые (int32_t, int64_t): +, -, * по модулю 2^N (дополнительный код),
+// без UB; деление с усечением к нулю, MIN // -1 == MIN
+template<std::signed_integral T>
+struct ValueTraits<T> {
+    using U = std::make_unsigned_t<T>;
+
+    static T add(T a, T b) { return static_cast<T>(static_cast<U>(a) + static_cast<U>(b)); }
+    static T subtract(T a, T b) { return static_cast<T>(static_cast<U>(a) - static_cast<U>(b)); }
+    static T multiply(T a, T b) { return static_cast<T>(static_cast<U>(a) * static_cast<U>(b)); }
+
+    static T divide(T a, T b) {
+        if (b == 0) throw std::logic_error("Division by zero!");
+        if (b == -1) return static_cast<T>(U{0} - static_cast<U>(a));  // MIN / -1 аппаратно бросает #DE
+        return a / b;
+    }
+};
+
+// double: +, -, * по IEEE 754; целочисленное деление - частное,
+// усечённое к нулю (как у целых), деление на ноль - ошибка, а не бесконечность
+template<>
+struct ValueTraits<double> {
+    static double add(double a, double b) { return a + b; }
+    static double subtract(double a, double b) { return a - b; }
+    static double multiply(double a, double b) { return a * b; }
+
+    static double divide(double a, double b) {
+        if (b == 0) throw std::logic_error("Division by zero!");
+        return std::trunc(a / b);
+    }
+};
+
+// Checked<T>: результат, не представимый в T, - std::overflow_error
+// (включая MIN // -1); деление с усечением к нулю
+template<std::signed_integral T>
+struct ValueTraits<Checked<T>> {
+    using C = Checked<T>;
+
+    static C add(C a, C b) {
+        T r;
+        if (__builtin_add_overflow(a.value, b.value, &r)) throw std::overflow_error("Integer overflow in +");
+        return r;
+    }
+
+    static C subtract(C a, C b) {
+        T r;
+        if (__builtin_sub_overflow(a.value, b.value, &r)) throw std::overflow_error("Integer overflow in -");
+        return r;
+    }
+
+    static C multiply(C a, C b) {
+        T r;
+        if (__builtin_mul_overflow(a.value, b.value, &r)) throw std::overflow_error("Integer overflow in *");
+        return r;
+    }
+
+    static C divide(C a, C b) {
+        if (b.value == 0) throw std::logic_error("Division by zero!");
+        if (a.value == std::numeric_limits<T>::min() && b.value == -1) throw std::overflow_error("Integer overflow in //");
+        return a.value / b.value;
+    }
+};
+
+#endif //VALUETRAITS_H
@@ -0,0 +1,86 @@
+#ifndef VARIABLELAYOUT_H
+#define VARIABLELAYOUT_H
+
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Expression.hpp"
+
+//------------------------------
+// Раскладка контекста: имя переменной -> плотный номер слота.
+// Контекст вычисления - плоский массив int, где значение переменной
+// лежит по её слоту; имена ищутся один раз, при связывании выражения
+//------------------------------
+class VariableLayout {
+    std::vector<std::string> names;
+    std::unordered_map<std::string, size_t> index;
+
+    static void collect(const Expression& e, VariableLayout& layout) {
+        if (e.kind() == ExprKind::Variable) {
+            layout.add(static_cast<const Variable&>(e).getName());
+        } else if (e.kind() != ExprKind::Constant) {
+            auto& bin = static_cast<const BinaryOp&>(e);
+            collect(*bin.getLeft(), layout);
+            collect(*bin.getRight(), layout);
+        }
+    }
+
+public:
+    VariableLayout() = default;
+
+    VariableLayout(std::initializer_list<std::string> variables) {
+        for (const auto& name : variables) add(name);
+    }
+
+    // Раскладка из переменных выражения в порядке первого появления
+    static VariableLayout of(const Expression& e) {
+        VariableLayout layout;
+        collect(e, layout);
+        return layout;
+    }
+
+    // Слот переменной; новая переменная получает следующий свободный
+    size_t add(const std::string& name) {
+        auto [it, inserted] = index.try_emplace(name, names.size());
+        if (inserted) names.push_back(name);
+        return it->second;
+    }
+
+    std::optional<size_t> find(const std::string& name) const {
+        auto it = index.find(name);
+        if (it == index.end()) return std::nullopt;
+        return it->second;
+    }
+
+    // Слот переменной; отсутствие переменной - ошибка связывания
+    size_t slotOf(const std::string& name) const {
+        auto it = index.find(name);
+        if (it == index.end()) {
+            throw std::logic_error("Variable " + name + " does not exist!");
+        }
+        return it->second;
+    }
+
+    size_t size() const { return names.size(); }
+
+    const std::vector<std::string>& variables() const { return names; }
+
+    // Плоский контекст из словаря; словарь должен содержать все переменные раскладки
+    std::vector<int> makeContext(const std::map<std::string, int>& vars) const {
+        std::vector<int> context;
+        context.reserve(names.size());
+        for (const auto& name : names) {
+            auto it = vars.find(name);
+            if (it == vars.end()) {
+                throw std::logic_error("Variable " + name + " does not exist!");
+            }
+            context.push_back(it->second);
+        }
+        return context;
+    }
+};
+
+#endif //VARIABLELAYOUT_H
@@ -0,0 +1,137 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//------------------------------
+// Пул потоков с перехватом работы (work stealing) для parallelFor.
+// Задачи - номера 0..n-1; каждый поток получает свой непрерывный отрезок
+// в собственную очередь и берёт задачи с её конца, а опустошив её,
+// забирает задачи с начала чужих очередей. Вызывающий поток работает
+// как поток номер 0, так что пул из одного потока не создаёт std::thread
+//------------------------------
+class WorkStealingPool {
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(size_t, size_t)>* job = nullptr;
+    size_t generation = 0;
+    size_t active = 0;  // Фоновые потоки, ещё не закончившие текущий parallelFor
+    bool stopping = false;
+    std::exception_ptr failure;
+
+    bool next(size_t worker, size_t& task) {
+        {
+            Queue& own = *queues[worker];
+            std::lock_guard lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); ++i) {
+            Queue& victim = *queues[(worker + i) % queues.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(size_t worker) {
+        size_t task;
+        while (next(worker, task)) {
+            try {
+                (*job)(task, worker);
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                if (!failure) failure = std::current_exception();
+            }
+        }
+    }
+
+    void loop(size_t worker) {
+        size_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            work(worker);
+            std::lock_guard lock(mutex);
+            if (--active == 0) done.notify_all();
+        }
+    }
+
+public:
+    explicit WorkStealingPool(size_t threadCount = std::thread::hardware_concurrency()) {
+        threadCount = std::max<size_t>(threadCount, 1);
+        for (size_t i = 0; i < threadCount; ++i) queues.push_back(std::make_unique<Queue>());
+        for (size_t i = 1; i < threadCount; ++i) threads.emplace_back(&WorkStealingPool::loop, this, i);
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    // Число потоков, включая вызывающий
+    size_t size() const { return queues.size(); }
+
+    // Вызывает f(task, worker) для task = 0..tasks-1 и ждёт завершения всех.
+    // worker < size() - номер потока, по нему удобно держать буферы потока.
+    // Первое исключение из f пробрасывается после завершения остальных задач
+    void parallelFor(size_t tasks, const std::function<void(size_t, size_t)>& f) {
+        const size_t n = queues.size();
+        for (size_t w = 0; w < n; ++w) {
+            Queue& q = *queues[w];
+            std::lock_guard lock(q.mutex);
+            for (size_t t = tasks * w / n; t < tasks * (w + 1) / n; ++t) q.tasks.push_back(t);
+        }
+        {
+            std::lock_guard lock(mutex);
+            job = &f;
+            failure = nullptr;
+            active = threads.size();
+            ++generation;
+        }
+        wake.notify_all();
+        work(0);
+
+        std::unique_lock lock(mutex);
+        done.wait(lock, [&] { return active == 0; });
+        job = nullptr;
+        if (failure) std::rethrow_exception(std::exchange(failure, nullptr));
+    }
+};
+
+#endif //WORKSTEALINGPOOL_H
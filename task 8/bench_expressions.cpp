@@ -0,0 +1,899 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ExpressionFactory.hpp"
+#include "Bytecode.hpp"
+#include "BatchEvaluator.hpp"
+#include "Parser.hpp"
+#include "ExpressionArena.hpp"
+#include "Jit.hpp"
+#include "IncrementalEvaluator.hpp"
+#include "ParallelEvaluator.hpp"
+#include "ExpressionSnapshot.hpp"
+#include "RangeAnalysis.hpp"
+#include "MemoCache.hpp"
+#include "ExpressionPrinter.hpp"
+
+// Бенчмарки вычисления выражений task 8:
+//   bytecode - обход дерева Expression::evaluate против байткода на "глубоких"
+//              (цепочка длины N) и "широких" (сбалансированное дерево) выражениях;
+//   batch    - построчное вычисление против пакетного по столбцам;
+//   dag      - выражение с общими подвыражениями из ExpressionFactory: обход
+//              дерева считает каждый общий узел заново, байткод - один раз;
+//   factory  - построение выражений из N различных констант через фабрику:
+//              время на узел не должно расти с N; построение из нескольких
+//              потоков, шардированный пул против пула под одним мьютексом;
+//   parse    - разбор текстовых правил ExpressionParser (правил в секунду);
+//   arena    - память на узел и обход большого выражения: shared_ptr-дерево
+//              против ExpressionArena;
+//   jit      - дифференциальная проверка JitExpression против evaluate на
+//              случайных выражениях (включая деление на ноль) и скорость JIT;
+//   incremental - тысячи выражений с общими подвыражениями, меняется одна
+//              переменная: пересчёт всего против IncrementalEvaluator::set;
+//   parallel - ParallelEvaluator на 1, 2, 4... потоках (до числа ядер);
+//   snapshot - холодный старт N правил: разбор текста через фабрику против
+//              открытия снимка MappedExpressions, сверка результатов;
+//   ranges   - деления с проверками против доказанных RangeAnalysis безопасными
+//              в байткоде, пакетном вычислении и JIT (переменные в [1, 8]);
+//   memo     - повторяющиеся контексты: обход дерева против MemoizedExpression
+//              (попадания, промахи, вытеснение, несколько потоков-читателей);
+//   symbols  - обход дерева по словарю имён против контекста по номерам SymbolTable;
+//   print    - вывод N выражений: Expression::print в поток против ExpressionPrinter.
+// Запуск: task_8_bench [раздел|all] [размер выражения] [число вычислений/строк]
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    volatile long long sink = 0;  // Не даёт компилятору выбросить результаты
+
+    const std::vector<std::string> kNames{"x", "y", "z", "w"};
+
+    // Лист: переменная или ненулевая константа
+    ExprPtr leaf(std::mt19937& rng) {
+        auto& factory = ExpressionFactory::instance();
+        if (rng() % 2) return factory.getVariable(kNames[rng() % kNames.size()]);
+        return factory.getConstant(static_cast<int>(rng() % 9) + 1);
+    }
+
+    // ((((x + 3) * 2) // 3) - y) ...: значения не растут, деление только на константы
+    ExprPtr deep(size_t n, std::mt19937& rng) {
+        auto& factory = ExpressionFactory::instance();
+        ExprPtr e = leaf(rng);
+        for (size_t i = 0; i < n; ++i) {
+            switch (i % 4) {
+                case 0: e = std::make_shared<Add>(e, leaf(rng)); break;
+                case 1: e = std::make_shared<Multiply>(e, factory.getConstant(2)); break;
+                case 2: e = std::make_shared<IntegerDivide>(e, factory.getConstant(3)); break;
+                default: e = std::make_shared<Subtract>(leaf(rng), e); break;
+            }
+        }
+        return e;
+    }
+
+    // Сбалансированное дерево из n листьев: сложения и вычитания,
+    // у нижнего уровня - умножения
+    ExprPtr wide(size_t n, std::mt19937& rng, bool bottom = true) {
+        if (n <= 1) return leaf(rng);
+        auto l = wide(n / 2, rng, n <= 3), r = wide(n - n / 2, rng, n <= 3);
+        if (bottom && n == 2) return std::make_shared<Multiply>(l, r);
+        if (rng() % 2) return std::make_shared<Add>(l, r);
+        return std::make_shared<Subtract>(l, r);
+    }
+
+    // Время одного вычисления в наносекундах
+    double measure(size_t iterations, const std::function<int(size_t)>& body) {
+        long long acc = 0;
+        auto start = Clock::now();
+        for (size_t i = 0; i < iterations; ++i) acc += body(i);
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        sink = sink + acc;
+        return ns / static_cast<double>(iterations);
+    }
+
+    void report(const std::string& name, double ns, double baseline) {
+        std::cout << "  " << std::left << std::setw(30) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << ns << " ns"
+                  << std::setw(10) << std::setprecision(2) << baseline / ns << "x\n";
+    }
+
+    bool benchBytecode(const std::string& shape, const ExprPtr& expr, size_t iterations) {
+        // Контексты меняются от итерации к итерации, чтобы не мерить один и тот же путь
+        std::vector<std::map<std::string, int>> contexts;
+        std::vector<std::vector<int>> slotContexts;
+        auto program = BytecodeCompiler::compile(expr);
+        for (int i = 0; i < 16; ++i) {
+            std::map<std::string, int> context;
+            for (size_t v = 0; v < kNames.size(); ++v) context[kNames[v]] = i * 7 + static_cast<int>(v) - 20;
+            slotContexts.push_back(program.layout().makeContext(context));
+            contexts.push_back(std::move(context));
+        }
+
+        bool ok = true;
+        for (size_t i = 0; i < contexts.size(); ++i) {
+            ok &= expr->evaluate(contexts[i]) == program.run(slotContexts[i]);
+        }
+
+        std::cout << shape << ": " << program.size() << " instructions\n";
+        double tree = measure(iterations, [&](size_t i) { return expr->evaluate(contexts[i % 16]); });
+        report("tree-walking evaluate", tree, tree);
+        report("bytecode evaluate(map)", measure(iterations, [&](size_t i) { return program.evaluate(contexts[i % 16]); }), tree);
+        report("bytecode run(slots)", measure(iterations, [&](size_t i) { return program.run(slotContexts[i % 16]); }), tree);
+        return ok;
+    }
+
+    // Одно выражение на rows строк; делитель w равен нулю примерно в 1% строк
+    bool benchBatch(size_t size, size_t rows) {
+        std::mt19937 rng(85);
+        auto& factory = ExpressionFactory::instance();
+        ExprPtr expr = std::make_shared<IntegerDivide>(wide(size, rng), factory.getVariable("w"));
+        BatchEvaluator batch(*expr, VariableLayout{"x", "y", "z", "w"});
+        auto program = BytecodeCompiler::compile(expr, batch.layout());
+
+        std::vector<std::vector<int>> columns(kNames.size(), std::vector<int>(rows));
+        std::uniform_int_distribution<int> dist(-100, 100);
+        for (auto& column : columns) {
+            for (int& v : column) v = dist(rng);
+        }
+        for (int& v : columns[3]) v = rng() % 100 ? (v ? v : 1) : 0;
+        std::vector<std::span<const int>> spans(columns.begin(), columns.end());
+        std::vector<int> rowMajor(rows * kNames.size());
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t c = 0; c < kNames.size(); ++c) rowMajor[r * kNames.size() + c] = columns[c][r];
+        }
+
+        std::cout << "batch: " << size << "-leaf expression over " << rows << " rows, "
+                  << batch.kernelCount() << " kernels, " << batch.temporaries() << " temporary blocks\n";
+
+        // Построчные варианты бросают исключение на строках с делением на ноль
+        auto rowByRow = [&](auto&& evaluateRow, size_t n) {
+            long long acc = 0;
+            auto start = Clock::now();
+            for (size_t r = 0; r < n; ++r) {
+                try {
+                    acc += evaluateRow(r);
+                } catch (const std::logic_error&) {
+                    --acc;
+                }
+            }
+            sink = sink + acc;
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(n);
+        };
+
+        size_t mapRows = std::min<size_t>(rows, 100'000);
+        std::vector<std::map<std::string, int>> contexts(mapRows);
+        for (size_t r = 0; r < mapRows; ++r) {
+            for (size_t c = 0; c < kNames.size(); ++c) contexts[r][kNames[c]] = columns[c][r];
+        }
+        double tree = rowByRow([&](size_t r) { return expr->evaluate(contexts[r]); }, mapRows);
+        report("tree-walking, per row", tree, tree);
+        report("bytecode, per row", rowByRow([&](size_t r) {
+            return program.run(std::span<const int>(rowMajor).subspan(r * kNames.size(), kNames.size()));
+        }, rows), tree);
+
+        std::vector<int> out(rows);
+        std::vector<uint8_t> errors(rows);
+        size_t failed = 0;
+        auto start = Clock::now();
+        failed = batch.evaluate(spans, out, errors);
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(rows);
+        report("batch, per row", ns, tree);
+        std::cout << "  rows with division by zero: " << failed << '\n';
+
+        bool ok = true;
+        for (size_t r = 0; r < rows; r += 7) {
+            try {
+                int expected = program.run(std::span<const int>(rowMajor).subspan(r * kNames.size(), kNames.size()));
+                ok &= !errors[r] && out[r] == expected;
+            } catch (const std::logic_error&) {
+                ok &= errors[r] == 1;
+            }
+        }
+        return ok;
+    }
+
+    // e(i+1) = ((e(i) - x) // 2) + (e(i) // 3): каждый уровень ссылается на e(i) дважды
+    bool benchDag(size_t levels, size_t iterations) {
+        auto& factory = ExpressionFactory::instance();
+        ExprPtr e = factory.getVariable("y");
+        for (size_t i = 0; i < levels; ++i) {
+            e = factory.getAdd(
+                factory.getIntegerDivide(factory.getSubtract(e, factory.getVariable("x")), factory.getConstant(2)),
+                factory.getIntegerDivide(e, factory.getConstant(3)));
+        }
+        auto program = BytecodeCompiler::compile(e);
+        std::map<std::string, int> context{{"x", 5}, {"y", 1 << 20}};
+        auto slots = program.layout().makeContext(context);
+
+        std::cout << "dag: " << levels << " levels, " << program.size() << " instructions\n";
+        double tree = measure(iterations, [&](size_t) { return e->evaluate(context); });
+        report("tree-walking evaluate", tree, tree);
+        report("bytecode run(slots)", measure(iterations, [&](size_t) { return program.run(slots); }), tree);
+        return e->evaluate(context) == program.run(slots);
+    }
+
+    // Сбалансированная сумма констант 0..n-1 (цепочка из миллиона узлов
+    // переполнила бы стек при рекурсивном разрушении)
+    double buildSum(size_t n) {
+        auto& factory = ExpressionFactory::instance();
+        auto start = Clock::now();
+        std::vector<ExprPtr> level;
+        level.reserve(n);
+        for (size_t i = 0; i < n; ++i) level.push_back(factory.getConstant(static_cast<int>(i)));
+        while (level.size() > 1) {
+            std::vector<ExprPtr> next;
+            next.reserve(level.size() / 2 + 1);
+            for (size_t i = 0; i + 1 < level.size(); i += 2) next.push_back(factory.getAdd(level[i], level[i + 1]));
+            if (level.size() % 2) next.push_back(level.back());
+            level = std::move(next);
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        sink = sink + static_cast<long long>(level.size());
+        return ns / static_cast<double>(2 * n - 1);
+    }
+
+    bool benchFactory(size_t maxConstants) {
+        std::cout << "factory: expression from N distinct constants (ns per node)\n";
+        for (size_t n = 1000; n <= maxConstants; n *= 10) {
+            std::cout << "  " << std::left << std::setw(30) << ("N = " + std::to_string(n)) << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(12) << buildSum(n) << " ns\n";
+        }
+        std::cout << "  pool entries after release: " << ExpressionFactory::instance().poolSize()
+                  << ", after prune: " << (ExpressionFactory::instance().prune(), ExpressionFactory::instance().poolSize()) << '\n';
+
+        // Каждый поток интернирует свои ключи; узлы держатся до конца замера
+        auto contention = [&]<size_t Shards>(size_t threads) {
+            task_8::ShardedInternPool<int, Constant, std::hash<int>, Shards> pool;
+            const size_t perThread = maxConstants / threads;
+            std::vector<std::vector<std::shared_ptr<Constant>>> kept(threads);
+            auto start = Clock::now();
+            std::vector<std::thread> workers;
+            for (size_t t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    kept[t].reserve(2 * perThread);
+                    for (size_t round = 0; round < 2; ++round) {
+                        for (size_t i = 0; i < perThread; ++i) {
+                            int key = static_cast<int>(t * perThread + i);
+                            kept[t].push_back(pool.get(key, [key] { return std::make_shared<Constant>(key); }));
+                        }
+                    }
+                });
+            }
+            for (auto& w : workers) w.join();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            return static_cast<double>(2 * perThread * threads) / seconds / 1e6;
+        };
+
+        std::cout << "factory: concurrent interning, M ops/s (16 shards / 1 mutex)\n";
+        size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        for (size_t threads = 1; threads <= std::max<size_t>(cores, 4); threads *= 2) {
+            std::cout << "  " << std::left << std::setw(30) << (std::to_string(threads) + " threads") << std::right
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(12) << contention.operator()<16>(threads)
+                      << std::setw(12) << contention.operator()<1>(threads) << '\n';
+        }
+
+        // Фабрика из нескольких потоков: все потоки строят одни и те же выражения,
+        // так что общие узлы должны совпасть
+        std::vector<std::thread> workers;
+        std::vector<ExprPtr> built(4);
+        for (size_t t = 0; t < built.size(); ++t) {
+            workers.emplace_back([&, t] {
+                for (int round = 0; round < 100; ++round) {
+                    built[t] = ExpressionParser::parse("((2 + x) * (y - 3)) // (z + 1) + (2 + x) * 5");
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        bool same = true;
+        for (const auto& e : built) same &= e == built[0];
+        std::cout << "  parallel parse produced " << (same ? "one shared node" : "DIFFERENT NODES") << '\n';
+        return same;
+    }
+
+    // Правила вида "((x + 3) * (y // 2)) - ..." из случайных выражений по ~16 листьев
+    bool benchParse(size_t rules) {
+        std::mt19937 rng(89);
+        std::vector<std::string> texts;
+        size_t bytes = 0;
+        for (size_t i = 0; i < 1000; ++i) {
+            std::ostringstream os;
+            wide(8 + rng() % 16, rng)->print(os);
+            texts.push_back(os.str());
+            bytes += texts.back().size();
+        }
+
+        // Пока живы разобранные выражения, фабрика отдаёт существующие узлы:
+        // так мерится разбор, а не аллокация
+        std::vector<ExprPtr> keep;
+        for (const auto& text : texts) keep.push_back(ExpressionParser::parse(text));
+
+        auto start = Clock::now();
+        size_t nodes = 0;
+        for (size_t i = 0; i < rules; ++i) nodes += ExpressionParser::parse(texts[i % texts.size()]).use_count();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        sink = sink + static_cast<long long>(nodes);
+
+        double perRule = static_cast<double>(bytes) / static_cast<double>(texts.size());
+        std::cout << "parse: " << rules << " rules, " << std::fixed << std::setprecision(0) << perRule << " bytes each\n"
+                  << "  " << std::setprecision(2) << static_cast<double>(rules) / seconds / 1e6 << " M rules/s, "
+                  << static_cast<double>(rules) * perRule / seconds / (1 << 20) << " MiB/s\n";
+
+        // Разбор напечатанного выражения возвращает тот же узел
+        bool ok = true;
+        for (size_t i = 0; i < texts.size(); ++i) {
+            std::ostringstream os;
+            keep[i]->print(os);
+            ok &= os.str() == texts[i] && ExpressionParser::parse(os.str()) == keep[i];
+        }
+
+        // Глубокая цепочка ((x + 0) + 1)...: до kMaxDepth разбирается,
+        // глубже - ошибка разбора, а не переполнение стека
+        auto chain = [](size_t depth) {
+            std::string text(depth, '(');
+            text += 'x';
+            for (size_t i = 0; i < depth; ++i) text += " + " + std::to_string(i % 10) + ')';
+            return text;
+        };
+        ok &= ExpressionParser::parse(chain(ExpressionParser::kMaxDepth)) != nullptr;
+        for (size_t depth : {ExpressionParser::kMaxDepth + 1, size_t{100'000}}) {
+            bool rejected = false;
+            try {
+                ExpressionParser::parse(chain(depth));
+            } catch (const std::logic_error&) {
+                rejected = true;
+            }
+            ok &= rejected;
+        }
+        std::cout << "  nesting: " << ExpressionParser::kMaxDepth << " levels parsed, deeper input rejected\n";
+        return ok;
+    }
+
+    // Выражение, которое не помещается в кеш: обход упирается в промахи
+    bool benchArena(size_t leaves, size_t iterations) {
+        std::mt19937 rng(90);
+        ExprPtr tree = wide(leaves, rng);
+        ExpressionArena arena(VariableLayout{"x", "y", "z", "w"});
+        auto root = arena.import(*tree);
+
+        // make_shared: объект + блок управления (два счётчика и vptr) + служебные байты malloc
+        size_t treeBytes = sizeof(Add) + 16 + 16;
+        std::cout << "arena: " << arena.size() << " nodes\n"
+                  << "  bytes per node: shared_ptr tree ~" << treeBytes << ", arena " << sizeof(ArenaNode) << '\n';
+
+        std::map<std::string, int> context{{"x", 1}, {"y", -2}, {"z", 3}, {"w", 4}};
+        auto slots = arena.layout().makeContext(context);
+        double treeNs = measure(iterations, [&](size_t) { return tree->evaluate(context); });
+        report("tree-walking evaluate", treeNs, treeNs);
+        report("arena evaluate(slots)", measure(iterations, [&](size_t) { return arena.evaluate(root, slots); }), treeNs);
+        return tree->evaluate(context) == arena.evaluate(root, slots);
+    }
+
+    // Случайное выражение глубины до depth: листья в [-3, 3], деления на что угодно.
+    // При глубине 4 произведение 16 листьев укладывается в int
+    ExprPtr randomExpression(std::mt19937& rng, int depth) {
+        auto& factory = ExpressionFactory::instance();
+        if (depth == 0 || rng() % 5 == 0) {
+            if (rng() % 2) return factory.getConstant(static_cast<int>(rng() % 7) - 3);
+            return factory.getVariable(kNames[rng() % kNames.size()]);
+        }
+        auto l = randomExpression(rng, depth - 1), r = randomExpression(rng, depth - 1);
+        return factory.getBinary(static_cast<ExprKind>(static_cast<int>(ExprKind::Add) + rng() % 4), l, r);
+    }
+
+    // Значение или текст исключения
+    template<class F>
+    std::string outcome(F&& f) {
+        try {
+            return std::to_string(f());
+        } catch (const std::logic_error& e) {
+            return e.what();
+        }
+    }
+
+    bool benchJit(size_t size, size_t iterations) {
+        std::mt19937 rng(91);
+        VariableLayout layout{"x", "y", "z", "w"};
+        size_t checks = 0, mismatches = 0, errors = 0;
+        for (int i = 0; i < 2000; ++i) {
+            ExprPtr e = randomExpression(rng, 4);
+            JitExpression jit(*e, layout);
+            for (int c = 0; c < 16; ++c) {
+                std::map<std::string, int> context;
+                for (const auto& name : kNames) context[name] = static_cast<int>(rng() % 7) - 3;
+                auto slots = layout.makeContext(context);
+                std::string expected = outcome([&] { return e->evaluate(context); });
+                std::string actual = outcome([&] { return jit.run(slots); });
+                errors += expected == "Division by zero!";
+                if (expected != actual && mismatches++ < 5) {
+                    e->print(std::cerr);
+                    std::cerr << ": evaluate " << expected << ", jit " << actual << '\n';
+                }
+                ++checks;
+            }
+        }
+        std::cout << "jit: " << (JitExpression(*deep(1, rng)).isNative() ? "native x86-64" : "bytecode fallback")
+                  << ", " << checks << " differential checks (" << errors << " divisions by zero), "
+                  << mismatches << " mismatches\n";
+
+        for (const auto& [shape, expr] : {std::pair{std::string("deep"), deep(size, rng)}, std::pair{std::string("wide"), wide(size, rng)}}) {
+            auto program = BytecodeCompiler::compile(expr, layout);
+            JitExpression jit(*expr, layout);
+            std::map<std::string, int> context{{"x", 1}, {"y", -2}, {"z", 3}, {"w", 4}};
+            auto slots = layout.makeContext(context);
+            std::cout << "  " << shape << ": " << program.size() << " instructions, " << jit.codeSize() << " bytes of code\n";
+            double vm = measure(iterations, [&](size_t) { return program.run(slots); });
+            report("bytecode run(slots)", vm, vm);
+            report("jit run(slots)", measure(iterations, [&](size_t) { return jit.run(slots); }), vm);
+            mismatches += program.run(slots) != jit.run(slots);
+        }
+        return mismatches == 0;
+    }
+
+    // Пул подвыражений над 64 переменными; каждое новое - "среднее" двух
+    // прежних, так что значения не растут, а подвыражения активно разделяются
+    bool benchIncremental(size_t roots, size_t updates) {
+        auto& factory = ExpressionFactory::instance();
+        std::mt19937 rng(92);
+        std::map<std::string, int> context;
+        std::vector<ExprPtr> pool;
+        for (int v = 0; v < 64; ++v) {
+            std::string name = std::to_string(v);
+            name.insert(name.begin(), 'v');
+            context[name] = static_cast<int>(rng() % 1000);
+            pool.push_back(factory.getVariable(name));
+        }
+        auto pick = [&] { return pool[pool.size() - 1 - std::min<size_t>(pool.size() - 1, rng() % 4096)]; };
+        for (size_t i = 0; i < 4 * roots; ++i) {
+            ExprPtr combined = rng() % 2 ? factory.getAdd(pick(), pick()) : factory.getSubtract(pick(), pick());
+            pool.push_back(factory.getIntegerDivide(combined, factory.getConstant(2)));
+        }
+
+        IncrementalEvaluator engine(context);
+        std::vector<BytecodeProgram> programs;
+        VariableLayout layout;
+        for (const auto& [name, value] : context) layout.add(name);
+        for (size_t i = 0; i < roots; ++i) {
+            engine.addRoot(pool[pool.size() - 1 - i]);
+            programs.push_back(BytecodeCompiler::compile(pool[pool.size() - 1 - i], layout));
+        }
+        std::cout << "incremental: " << roots << " expressions, " << engine.nodeCount() << " distinct nodes\n";
+
+        // Полный пересчёт: каждое выражение байткодом заново
+        auto slots = layout.makeContext(context);
+        double full = measure(std::max<size_t>(updates / 100, 5), [&](size_t i) {
+            slots[i % 64] += 1;
+            int acc = 0;
+            for (const auto& program : programs) acc += program.run(slots);
+            return acc;
+        });
+        report("re-evaluate everything", full, full);
+
+        size_t recomputed = 0;
+        double incremental = measure(updates, [&](size_t i) {
+            size_t v = rng() % 64;
+            recomputed += engine.set(layout.variables()[v], static_cast<int>(rng() % 1000));
+            return static_cast<int>(i);
+        });
+        report("IncrementalEvaluator::set", incremental, full);
+        std::cout << "  nodes recomputed per update: " << recomputed / updates << '\n';
+
+        bool ok = true;
+        slots = layout.makeContext(engine.variables());
+        for (size_t i = 0; i < roots; ++i) ok &= engine.value(i) == programs[i].run(slots);
+        return ok;
+    }
+
+    bool benchParallel(size_t expressions, size_t contexts) {
+        std::mt19937 rng(93);
+        std::vector<ExprPtr> exprs;
+        for (size_t i = 0; i < expressions; ++i) exprs.push_back(randomExpression(rng, 4));
+        VariableLayout layout{"x", "y", "z", "w"};
+        std::vector<int> rows(contexts * layout.size());
+        for (int& v : rows) v = static_cast<int>(rng() % 7) - 3;
+
+        size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        std::cout << "parallel: " << expressions << " expressions x " << contexts << " contexts, "
+                  << cores << " hardware threads\n";
+        std::vector<int> reference, results(expressions * contexts);
+        std::vector<uint8_t> failed(results.size());
+        bool ok = true;
+        double single = 0;
+        for (size_t threads = 1;; threads *= 2) {
+            threads = std::min(threads, cores);
+            ParallelEvaluator evaluator(exprs, layout, threads);
+            auto start = Clock::now();
+            size_t failures = evaluator.evaluate(rows, results, failed);
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (threads == 1) {
+                single = seconds;
+                reference = results;
+            } else {
+                ok &= results == reference;
+            }
+            std::cout << "  " << std::left << std::setw(30) << (std::to_string(threads) + " threads") << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(12)
+                      << static_cast<double>(results.size()) / seconds / 1e6 << " M evals/s"
+                      << std::setw(8) << std::setprecision(2) << single / seconds << "x  ("
+                      << failures << " divisions by zero)\n";
+            if (threads == cores) break;
+        }
+
+        // Выражения без переменных: раскладка пуста, число контекстов задаётся явно
+        auto& factory = ExpressionFactory::instance();
+        std::vector<ExprPtr> constants{factory.getConstant(3),
+                                       factory.getMultiply(factory.getConstant(2), factory.getConstant(5)),
+                                       factory.getIntegerDivide(factory.getConstant(7), factory.getConstant(0))};
+        const size_t count = 1000;
+        ParallelEvaluator constantEvaluator(constants, VariableLayout{}, std::min<size_t>(cores, 2));
+        std::vector<int> constantResults(constants.size() * count);
+        std::vector<uint8_t> constantFailed(constantResults.size());
+        ok &= constantEvaluator.evaluate({}, count, constantResults, constantFailed) == count;
+        for (size_t c = 0; c < count; ++c) {
+            ok &= constantResults[c] == 3 && constantResults[count + c] == 10 && !constantFailed[c] &&
+                  !constantFailed[count + c] && constantFailed[2 * count + c];
+        }
+        return ok;
+    }
+    // Правила хранятся текстом и при старте разбираются заново - против
+    // снимка, который открывается mmap и вычисляется на месте
+    bool benchSnapshot(size_t expressions) {
+        std::mt19937 rng(96);
+        std::vector<std::string> texts;
+        for (size_t i = 0; i < expressions; ++i) {
+            std::ostringstream os;
+            randomExpression(rng, 4)->print(os);
+            texts.push_back(os.str());
+        }
+        std::string path = (std::filesystem::temp_directory_path() / "task_8_rules.snap").string();
+        std::cout << "snapshot: cold start of " << expressions << " expressions\n";
+        auto ms = [](Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        };
+        auto line = [](const std::string& name, double value) {
+            std::cout << "  " << std::left << std::setw(30) << name << std::right << std::fixed
+                      << std::setprecision(3) << std::setw(12) << value << " ms\n";
+        };
+
+        auto start = Clock::now();
+        std::vector<ExprPtr> parsed;
+        parsed.reserve(texts.size());
+        for (const auto& text : texts) parsed.push_back(ExpressionParser::parse(text));
+        line("parse through the factory", ms(start));
+
+        start = Clock::now();
+        MappedExpressions::save(path, parsed);
+        line("save snapshot", ms(start));
+
+        start = Clock::now();
+        MappedExpressions mapped(path);
+        line("open snapshot", ms(start));
+        start = Clock::now();
+        mapped.verify();
+        line("  verify (reads every node)", ms(start));
+        std::cout << "  " << mapped.nodeCount() << " distinct nodes, " << mapped.fileSize() / 1024 << " KiB\n";
+
+        // Сверка: значение или ошибка совпадают у дерева и у снимка
+        std::map<std::string, int> context{{"x", 2}, {"y", -3}, {"z", 0}, {"w", 1}};
+        auto slots = mapped.layout().makeContext(context);
+        bool ok = mapped.size() == parsed.size();
+        start = Clock::now();
+        for (size_t i = 0; ok && i < parsed.size(); ++i) {
+            ok &= outcome([&] { return mapped.evaluate(i, slots); }) == outcome([&] { return parsed[i]->evaluate(context); });
+        }
+        line("evaluate all (checked)", ms(start));
+        std::ostringstream os;
+        mapped.print(0, os);
+        ok &= os.str() == texts[0] && mapped.toExpression(0) == parsed[0];
+
+        // Сохранение поверх открытого снимка: новый файл пишется рядом и
+        // заменяет старый, открытый снимок продолжает читать старый
+        std::vector<ExprPtr> head;
+        for (size_t i = 0; i < std::min<size_t>(mapped.size(), 100); ++i) head.push_back(mapped.toExpression(i));
+        MappedExpressions::save(path, head);
+        MappedExpressions resaved(path);
+        ok &= resaved.size() == head.size() && mapped.size() == parsed.size() &&
+              !std::filesystem::exists(path + ".tmp");
+        for (size_t i = 0; ok && i < head.size(); ++i) {
+            ok &= outcome([&] { return resaved.evaluate(i, resaved.layout().makeContext(context)); }) ==
+                  outcome([&] { return mapped.evaluate(i, slots); });
+        }
+        std::filesystem::remove(path);
+        return ok;
+    }
+    // Сбалансированное дерево из n листьев (переменные и константы 1..9):
+    // сложения и деления. Делитель - поддерево (частное может быть нулём)
+    // или поддерево + 1, которое при переменных >= 1 доказуемо положительно
+    ExprPtr divisions(size_t n, std::mt19937& rng, bool positiveDivisors) {
+        auto& factory = ExpressionFactory::instance();
+        if (n <= 1) {
+            if (rng() % 2) return factory.getVariable(kNames[rng() % kNames.size()]);
+            return factory.getConstant(static_cast<int>(rng() % 9) + 1);
+        }
+        auto l = divisions(n / 2, rng, positiveDivisors), r = divisions(n - n / 2, rng, positiveDivisors);
+        if (rng() % 2) return factory.getAdd(l, r);
+        if (positiveDivisors || rng() % 2) r = factory.getAdd(r, factory.getConstant(1));
+        return factory.getIntegerDivide(l, r);
+    }
+
+    bool benchRanges(size_t size, size_t iterations) {
+        std::mt19937 rng(97);
+        VariableLayout layout{"x", "y", "z", "w"};
+        VariableBounds bounds;
+        for (const auto& name : kNames) bounds[name] = {1, 8};
+        auto randomSlots = [&] {
+            std::vector<int> slots(layout.size());
+            for (int& v : slots) v = static_cast<int>(rng() % 8) + 1;
+            return slots;
+        };
+
+        // Сверка на случайных выражениях и контекстах в границах
+        size_t safe = 0, total = 0, mismatches = 0;
+        for (int i = 0; i < 500; ++i) {
+            ExprPtr e = divisions(2 + rng() % 30, rng, false);
+            RangeAnalysis ranges(*e, bounds);
+            safe += ranges.safeDivisionCount();
+            total += ranges.divisionCount();
+            auto program = BytecodeCompiler::compile(*e, layout, ranges);
+            JitExpression jit(*e, layout, ranges);
+            for (int c = 0; c < 16; ++c) {
+                auto slots = randomSlots();
+                std::map<std::string, int> context;
+                for (size_t k = 0; k < kNames.size(); ++k) context[kNames[k]] = slots[k];
+                std::string expected = outcome([&] { return e->evaluate(context); });
+                mismatches += outcome([&] { return program.run(slots); }) != expected;
+                mismatches += outcome([&] { return jit.run(slots); }) != expected;
+            }
+        }
+        // Пакетно строка с ошибкой досчитывается: проверяемое деление пишет в неё
+        // a / 1, и значение может выйти за отрезок анализа. Доказанное деление
+        // ниже по строке не должно от этого получить нулевой делитель
+        struct FaultCase {
+            const char* text;
+            VariableBounds bounds;
+            int xLo, xHi, yLo, yHi;
+        };
+        for (const FaultCase& fc : {FaultCase{"z // ((x // y) - 5)", {{"x", {1, 10}}, {"y", {-5, 0}}}, 1, 10, -5, 0},
+                                    FaultCase{"y // ((x // 0) + 1)", {}, -3, 3, 1, 3}}) {
+            ExprPtr e = ExpressionParser::parse(fc.text);
+            RangeAnalysis ranges(*e, fc.bounds);
+            std::vector<std::vector<int>> columns(layout.size());
+            for (int x = fc.xLo; x <= fc.xHi; ++x) {
+                for (int y = fc.yLo; y <= fc.yHi; ++y) {
+                    columns[0].push_back(x);
+                    columns[1].push_back(y);
+                    columns[2].push_back(7);
+                    columns[3].push_back(1);
+                }
+            }
+            std::vector<std::span<const int>> spans(columns.begin(), columns.end());
+            std::vector<int> out(columns[0].size());
+            std::vector<uint8_t> errors(out.size());
+            BatchEvaluator(*e, layout, ranges).evaluate(spans, out, errors);
+            for (size_t r = 0; r < out.size(); ++r) {
+                std::map<std::string, int> context{{"x", columns[0][r]}, {"y", columns[1][r]}, {"z", 7}, {"w", 1}};
+                std::string expected = outcome([&] { return e->evaluate(context); });
+                mismatches += (errors[r] ? std::string("Division by zero!") : std::to_string(out[r])) != expected;
+            }
+        }
+        std::cout << "ranges: " << safe << " of " << total << " divisions proven safe, "
+                  << mismatches << " mismatches\n";
+
+        // Для замера - выражение, все деления которого доказуемо безопасны
+        ExprPtr expr = divisions(size, rng, true);
+        RangeAnalysis ranges(*expr, bounds);
+        auto slots = randomSlots();
+        std::cout << "  " << size << "-leaf expression: " << ranges.safeDivisionCount() << " of "
+                  << ranges.divisionCount() << " divisions unchecked, result in [" << ranges.result().lo
+                  << ", " << ranges.result().hi << "]\n";
+        auto checkedProgram = BytecodeCompiler::compile(expr, layout);
+        auto provenProgram = BytecodeCompiler::compile(*expr, layout, ranges);
+        JitExpression checkedJit(*expr, layout), provenJit(*expr, layout, ranges);
+        double vm = measure(iterations, [&](size_t) { return checkedProgram.run(slots); });
+        report("bytecode, checked", vm, vm);
+        report("bytecode, proven", measure(iterations, [&](size_t) { return provenProgram.run(slots); }), vm);
+        report("jit, checked", measure(iterations, [&](size_t) { return checkedJit.run(slots); }), vm);
+        report("jit, proven", measure(iterations, [&](size_t) { return provenJit.run(slots); }), vm);
+        mismatches += provenProgram.run(slots) != checkedProgram.run(slots);
+        mismatches += provenJit.run(slots) != checkedProgram.run(slots);
+
+        // Пакетно: хвост строк не кратен блоку, дополнение тоже должно быть в границах
+        size_t rows = 100 * BatchEvaluator::kBlock + 17;
+        std::vector<std::vector<int>> columns(layout.size(), std::vector<int>(rows));
+        for (auto& column : columns) {
+            for (int& v : column) v = static_cast<int>(rng() % 8) + 1;
+        }
+        std::vector<std::span<const int>> spans(columns.begin(), columns.end());
+        BatchEvaluator checkedBatch(*expr, layout), provenBatch(*expr, layout, ranges);
+        std::vector<int> checkedOut(rows), provenOut(rows);
+        std::vector<uint8_t> checkedErrors(rows), provenErrors(rows);
+        auto perRow = [&](const BatchEvaluator& batch, std::vector<int>& out, std::vector<uint8_t>& errors) {
+            auto start = Clock::now();
+            for (int rep = 0; rep < 10; ++rep) batch.evaluate(spans, out, errors);
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(10 * rows);
+        };
+        double batch = perRow(checkedBatch, checkedOut, checkedErrors);
+        report("batch, checked, per row", batch, batch);
+        report("batch, proven, per row", perRow(provenBatch, provenOut, provenErrors), batch);
+        for (size_t r = 0; r < rows; ++r) {
+            mismatches += checkedErrors[r] != provenErrors[r] || (!checkedErrors[r] && checkedOut[r] != provenOut[r]);
+        }
+        return mismatches == 0;
+    }
+    bool benchMemo(size_t size, size_t iterations) {
+        std::mt19937 rng(98);
+        ExprPtr expr = deep(size, rng);
+        // Контексты повторяются: 80% обращений - к 200 "горячим", остальные
+        // к 20000 редким; в словаре есть и переменные, которых выражение не читает
+        std::vector<std::map<std::string, int>> contexts(20'200);
+        for (auto& context : contexts) {
+            for (const auto& name : kNames) context[name] = static_cast<int>(rng() % 1000);
+            context["unused"] = static_cast<int>(rng());
+        }
+        std::vector<size_t> trace(iterations);
+        for (size_t& i : trace) i = rng() % 5 ? rng() % 200 : 200 + rng() % 20'000;
+
+        MemoizedExpression memo(expr, 1024);
+        std::cout << "memo: " << size << "-operation expression, " << memo.layout().size()
+                  << " variables in the key, capacity " << memo.capacity() << '\n';
+        double tree = measure(iterations, [&](size_t i) { return expr->evaluate(contexts[trace[i]]); });
+        report("tree-walking evaluate", tree, tree);
+        report("memoised evaluate(map)", measure(iterations, [&](size_t i) { return memo.evaluate(contexts[trace[i]]); }), tree);
+        double rate = static_cast<double>(memo.hits()) / static_cast<double>(memo.hits() + memo.misses());
+        std::cout << "  hits " << memo.hits() << ", misses " << memo.misses() << " (hit rate "
+                  << std::setprecision(1) << 100 * rate << "%), " << memo.size() << " entries\n";
+
+        report("memoised, hits only", measure(iterations, [&](size_t i) { return memo.evaluate(contexts[i % 200]); }), tree);
+
+        bool ok = memo.size() <= memo.capacity();
+        for (size_t i = 0; i < contexts.size(); i += 13) {
+            ok &= memo.evaluate(contexts[i]) == expr->evaluate(contexts[i]);
+        }
+
+        // Несколько потоков по одному кешу: результаты те же, счётчики сходятся
+        memo.clear();
+        uint64_t before = memo.hits() + memo.misses();
+        std::vector<std::thread> threads;
+        std::atomic<size_t> wrong{0};
+        const size_t perThread = std::min<size_t>(iterations, 20'000);
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t] {
+                for (size_t i = 0; i < perThread; ++i) {
+                    const auto& context = contexts[trace[(i * 7 + static_cast<size_t>(t)) % trace.size()]];
+                    wrong += memo.evaluate(context) != expr->evaluate(context);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        ok &= wrong == 0 && memo.hits() + memo.misses() - before == 4 * perThread;
+        return ok;
+    }
+    bool benchSymbols(size_t size, size_t iterations) {
+        std::mt19937 rng(99);
+        ExprPtr expr = wide(size, rng);
+        std::map<std::string, int> context{{"x", 1}, {"y", -2}, {"z", 3}, {"w", 4}};
+        // Переменные, которых выражение не читает, делают словарь глубже
+        for (int i = 0; i < 60; ++i) {
+            std::string name = std::to_string(i);
+            name.insert(name.begin(), 'v');
+            context[name] = i;
+        }
+        auto symbols = SymbolContext::from(context);
+
+        std::cout << "symbols: " << size << "-leaf expression, " << context.size() << " variables in the context, "
+                  << SymbolTable::instance().size() << " symbols interned\n";
+        double byName = measure(iterations, [&](size_t) { return expr->evaluate(context); });
+        report("evaluate(map by name)", byName, byName);
+        report("evaluate(SymbolContext)", measure(iterations, [&](size_t) { return expr->evaluate(symbols); }), byName);
+
+        bool ok = expr->evaluate(context) == expr->evaluate(symbols);
+        // Отсутствующая переменная - та же ошибка, что и у словаря
+        SymbolContext partial;
+        partial.set("x", 1);
+        ok &= outcome([&] { return expr->evaluate(partial); }) == outcome([&] { return expr->evaluate(std::map<std::string, int>{{"x", 1}}); });
+        return ok;
+    }
+    bool benchPrint(size_t expressions) {
+        std::mt19937 rng(100);
+        std::vector<ExprPtr> exprs;
+        for (size_t i = 0; i < 1000; ++i) exprs.push_back(randomExpression(rng, 5));
+
+        // Дамп в поток, как для журнала: print каждого выражения и перевод строки
+        std::ostringstream viaPrint;
+        auto start = Clock::now();
+        for (size_t i = 0; i < expressions; ++i) {
+            exprs[i % exprs.size()]->print(viaPrint);
+            viaPrint << '\n';
+        }
+        double printSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        ExpressionPrinter printer;
+        std::ostringstream viaPrinter;
+        start = Clock::now();
+        for (size_t i = 0; i < expressions; ++i) {
+            printer.append(*exprs[i % exprs.size()]).append('\n');
+            if (printer.size() >= (1 << 16)) printer.flush(viaPrinter);
+        }
+        printer.flush(viaPrinter);
+        double printerSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        double mib = static_cast<double>(viaPrint.str().size()) / (1 << 20);
+        std::cout << "print: " << expressions << " expressions, " << std::fixed << std::setprecision(1) << mib << " MiB\n";
+        for (const auto& [name, seconds] : {std::pair{"Expression::print", printSeconds}, std::pair{"ExpressionPrinter", printerSeconds}}) {
+            std::cout << "  " << std::left << std::setw(30) << name << std::right << std::setw(12)
+                      << mib / seconds << " MiB/s" << std::setw(10) << std::setprecision(2)
+                      << printSeconds / seconds << "x\n" << std::setprecision(1);
+        }
+        bool ok = viaPrint.str() == viaPrinter.str();
+
+        // Глубокая цепочка: обход без рекурсии, текст тот же
+        ExprPtr chain = deep(100'000, rng);
+        std::ostringstream deepPrint;
+        chain->print(deepPrint);
+        ok &= ExpressionPrinter::toString(*chain) == deepPrint.str();
+        return ok;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string section = argc > 1 ? argv[1] : "all";
+    size_t size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 256;
+    size_t iterations = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100'000;
+    auto enabled = [&](const std::string& name) { return section == "all" || section == name; };
+
+    bool ok = true;
+    if (enabled("bytecode")) {
+        std::mt19937 rng(8);
+        ok &= benchBytecode("deep (" + std::to_string(size) + " operations)", deep(size, rng), iterations);
+        ok &= benchBytecode("wide (" + std::to_string(size) + " leaves)", wide(size, rng), iterations);
+    }
+    if (enabled("batch")) {
+        ok &= benchBatch(std::min<size_t>(size, 64), 10 * iterations);
+    }
+    if (enabled("dag")) {
+        ok &= benchDag(16, std::max<size_t>(iterations / 1000, 10));
+    }
+    if (enabled("factory")) {
+        ok &= benchFactory(10 * iterations);
+    }
+    if (enabled("parse")) {
+        ok &= benchParse(10 * iterations);
+    }
+    if (enabled("arena")) {
+        ok &= benchArena(1 << 18, std::max<size_t>(iterations / 10'000, 5));
+    }
+    if (enabled("jit")) {
+        ok &= benchJit(size, iterations);
+    }
+    if (enabled("incremental")) {
+        ok &= benchIncremental(5000, iterations / 10);
+    }
+    if (enabled("parallel")) {
+        ok &= benchParallel(10'000, iterations / 100);
+    }
+    if (enabled("snapshot")) {
+        ok &= benchSnapshot(10 * iterations);
+    }
+    if (enabled("ranges")) {
+        ok &= benchRanges(size, iterations);
+    }
+    if (enabled("memo")) {
+        ok &= benchMemo(size, iterations);
+    }
+    if (enabled("symbols")) {
+        ok &= benchSymbols(size, iterations);
+    }
+    if (enabled("print")) {
+        ok &= benchPrint(10 * iterations);
+    }
+    std::cout << (ok ? "results match" : "RESULTS DIFFER") << '\n';
+    return ok ? 0 : 1;
+}
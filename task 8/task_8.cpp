@@ -1,184 +1,14 @@
-#include <iostream>
-#include <string>
-#include <map>
-#include <memory>
-
-
-// Базовый интерфейс для всех выражений в AST (Abstract Syntax Tree)
-// Определяет основные операции, которые должны поддерживать все выражения
-class Expression {
-public:
-    virtual ~Expression() = default;
-    
-    // Выводит текстовое представление выражения в выходной поток
-    virtual void print(std::ostream& os) const = 0;
-    
-    // Вычисляет значение выражения с использованием переданных переменных
-    virtual int evaluate(const std::map<std::string,int>& vars) const = 0;
-};
-
-using ExprPtr = std::shared_ptr<Expression>; // Удобный псевдоним для shared_ptr
-
-//------------------------------
-// Листовые узлы AST (терминальные выражения)
-//------------------------------
-
-// Константное целочисленное значение
-class Constant : public Expression {
-    int value;
-public:
-    explicit Constant(int v) : value(v) {}
-    
-    void print(std::ostream& os) const override { os << value; }
-    
-    int evaluate(const std::map<std::string,int>&) const override { 
-        return value; 
-    }
-};
-
-// Переменная, значение которой берется из контекста
-class Variable : public Expression {
-    std::string name;
-public:
-    explicit Variable(std::string n) : name(std::move(n)) {}
-    
-    void print(std::ostream& os) const override { os << name; }
-    
-    int evaluate(const std::map<std::string,int>& vars) const override {
-        if (!vars.contains(name)) {
-            throw std::logic_error("Variable " + name + " does not exist!");
-        }
-        return vars.at(name);
-    }
-};
-
-//------------------------------
-// Составные узлы AST (нетерминальные выражения)
-//------------------------------
-
-// Базовый класс для всех бинарных операций
-class BinaryOp : public Expression {
-protected:
-    ExprPtr left;   // Левый операнд
-    ExprPtr right;  // Правый операнд
-    std::string op; // Символ операции (для вывода)
-    
-public:
-    BinaryOp(ExprPtr l, ExprPtr r, std::string operation)
-        : left(std::move(l)), right(std::move(r)), op(std::move(operation)) {}
-        
-    void print(std::ostream& os) const override {
-        os << "(";
-        left->print(os);
-        os << ' ' << op << ' ';
-        right->print(os);
-        os << ")";
-    }
-};
-
-// Операция сложения (+)
-class Add : public BinaryOp {
-public:
-    Add(ExprPtr l, ExprPtr r) : BinaryOp(l, r, "+") {}
-    
-    int evaluate(const std::map<std::string, int>& vars) const override {
-        return left->evaluate(vars) + right->evaluate(vars);
-    }
-};
-
-// Операция вычитания (-)
-class Subtract : public BinaryOp {
-public:
-    Subtract(ExprPtr l, ExprPtr r) : BinaryOp(l, r, "-") {}
-    
-    int evaluate(const std::map<std::string, int>& vars) const override {
-        return left->evaluate(vars) - right->evaluate(vars);
-    }
-};
-
-// Операция целочисленного деления (//)
-class IntegerDivide : public BinaryOp {
-public:
-    IntegerDivide(ExprPtr l, ExprPtr r) : BinaryOp(l, r, "//") {}
-    
-    int evaluate(const std::map<std::string, int>& vars) const override {
-        int divisor = right->evaluate(vars);
-        if (divisor == 0) {
-            throw std::logic_error("Division by zero!");
-        }
-        return left->evaluate(vars) / divisor;
-    }
-};
-
-// Операция умножения (*)
-
-class Multiply : public BinaryOp {
-public:
-    Multiply(ExprPtr l, ExprPtr r) : BinaryOp(l, r, "*") {}
-    
-    int evaluate(const std::map<std::string,int>& vars) const override {
-        return left->evaluate(vars) * right->evaluate(vars);
-    }
-};
-
-//------------------------------
-// Фабрика выражений (реализована как Singleton)
-// Использует пулы объектов для хранения констант и переменных
-//------------------------------
-class ExpressionFactory {
-    std::map<int, std::weak_ptr<Constant>> constPool;     // Пул констант
-    std::map<std::string, std::weak_ptr<Variable>> varPool; // Пул переменных
-
-    // Приватный конструктор для Singleton
-    ExpressionFactory() = default;
-    
-public:
-    // Получение экземпляра фабрики
-    static ExpressionFactory& instance() {
-        static ExpressionFactory factory;
-        return factory;
-    }
-
-
-    // Получение константы (с использованием пула)
-    ExprPtr getConstant(int v) {
-        prune(constPool);
-        auto& wp = constPool[v]; // weak_ptr для данного значения
-        
-        // Пытаемся преобразовать weak_ptr в shared_ptr
-        if (auto sp = wp.lock()) {
-            return sp; // Возвращаем существующий объект
-        }
-
-        // Создаем новый объект, если в пуле нет живого shared_ptr
-        auto sp = std::make_shared<Constant>(v);
-        wp = sp; // Обновляем weak_ptr в пуле
-        return sp;
-    }
-
-    // Получение переменной (с использованием пула)
-    ExprPtr getVariable(const std::string& name) {
-        prune(varPool);
-        auto& wp = varPool[name];
-        if (auto sp = wp.lock()) return sp;
-        
-        auto sp = std::make_shared<Variable>(name);
-        wp = sp;
-        return sp;
-    }
-
-    // Очистка пула от "мертвых" weak_ptr
-    template<typename K, typename WP>
-    void prune(std::map<K, WP>& pool) {
-        for (auto it = pool.begin(); it != pool.end(); ) {
-            if (it->second.expired()) {
-                it = pool.erase(it); // Удаляем записи с истекшими weak_ptr
-            } else {
-                ++it;
-            }
-        }
-    }
-};
+#include <sstream>
+#include "ExpressionFactory.hpp"
+#include "Bytecode.hpp"
+#include "BatchEvaluator.hpp"
+#include "Optimizer.hpp"
+#include "Parser.hpp"
+#include "ExpressionArena.hpp"
+#include "Jit.hpp"
+#include "IncrementalEvaluator.hpp"
+#include "RangeAnalysis.hpp"
+#include "ExpressionPrinter.hpp"
 
 //------------------------------
 // Пример использования
@@ -203,6 +33,27 @@ int main() {
         // Выводим и вычисляем выражение
         expr->print(std::cout);
         std::cout << " = " << expr->evaluate(context) << '\n';
+
+        // То же выражение, скомпилированное в байткод
+        auto program = BytecodeCompiler::compile(expr);
+        program.disassemble(std::cout);
+        std::cout << "bytecode: " << program.evaluate(context) << '\n';
+
+        // Пакетное вычисление по столбцу значений x; в x // y деление
+        // на ноль помечается в строке, а не бросает исключение
+        std::vector<int> xs{0, 1, 2, 3}, ys{1, 0, 2, -1};
+        std::vector<std::span<const int>> columns{xs, ys};
+        std::vector<int> out(xs.size());
+        std::vector<uint8_t> errors(xs.size());
+        BatchEvaluator(*expr, VariableLayout{"x"}).evaluate(columns, out, errors);
+        for (int v : out) std::cout << v << ' ';
+        std::cout << '\n';
+        auto quotient = std::make_shared<IntegerDivide>(factory.getVariable("x"), factory.getVariable("y"));
+        BatchEvaluator(*quotient, VariableLayout{"x", "y"}).evaluate(columns, out, errors);
+        for (size_t i = 0; i < out.size(); ++i) {
+            std::cout << (errors[i] ? std::string("error") : std::to_string(out[i])) << ' ';
+        }
+        std::cout << '\n';
     }
 
     // Другой пример выражения (не вычисляется в этом примере)
@@ -210,4 +61,144 @@ int main() {
         factory.getConstant(3),
         factory.getVariable("xx")
     );
+
+    // Хеширование составных узлов: (2 + x), собранное дважды, - один узел,
+    // а в байткоде его значение вычисляется один раз и берётся из temps
+    {
+        auto sum = factory.getAdd(factory.getConstant(2), factory.getVariable("x"));
+        auto same = factory.getAdd(factory.getConstant(2), factory.getVariable("x"));
+        std::cout << "(2 + x) shared: " << std::boolalpha << (sum == same) << '\n';
+        auto square = factory.getMultiply(sum, same);
+        auto program = BytecodeCompiler::compile(square);
+        program.disassemble(std::cout);
+        square->print(std::cout);
+        std::cout << " = " << program.evaluate({{"x", 3}}) << '\n';
+    }
+
+    // Свёртка констант и упрощение: ((x * 1) + (2 * 3)) + ((y - y) + (4 + (z * 0)))
+    {
+        auto x = factory.getVariable("x"), y = factory.getVariable("y"), z = factory.getVariable("z");
+        auto expr = factory.getAdd(
+            factory.getAdd(factory.getMultiply(x, factory.getConstant(1)),
+                           factory.getMultiply(factory.getConstant(2), factory.getConstant(3))),
+            factory.getAdd(factory.getSubtract(y, y),
+                           factory.getAdd(factory.getConstant(4), factory.getMultiply(z, factory.getConstant(0)))));
+        auto result = ExpressionOptimizer::optimize(expr);
+        expr->print(std::cout);
+        std::cout << " -> ";
+        result.expr->print(std::cout);
+        std::cout << " (" << result.eliminated() << " of " << result.nodesBefore << " nodes eliminated)\n";
+    }
+
+    // Разбор текстового правила; вывод разбирается обратно в тот же узел
+    {
+        auto rule = ExpressionParser::parse("(2 + x) * 5 // y");
+        rule->print(std::cout);
+        std::cout << " = " << rule->evaluate({{"x", 3}, {"y", 2}}) << '\n';
+        std::ostringstream printed;
+        rule->print(printed);
+        std::cout << "round trip: " << std::boolalpha << (ExpressionParser::parse(printed.str()) == rule) << '\n';
+        std::cout << "printer: " << (ExpressionPrinter::toString(*rule) == printed.str() ? "same text" : "DIFFERENT TEXT") << '\n';
+        try {
+            ExpressionParser::parse("(2 + x * 5");
+        } catch (const std::logic_error& e) {
+            std::cout << e.what() << '\n';
+        }
+    }
+
+    // То же правило в арене: узлы подряд в одном векторе, операнды - индексы
+    {
+        ExpressionArena arena;
+        auto root = arena.integerDivide(
+            arena.multiply(arena.add(arena.constant(2), arena.variable("x")), arena.constant(5)),
+            arena.variable("y"));
+        arena.print(root, std::cout);
+        std::cout << " = " << arena.evaluate(root, {{"x", 3}, {"y", 2}})
+                  << " (" << arena.memoryUsage() << " bytes)\n";
+    }
+
+    // JIT: то же правило в машинном коде (или байткод, если JIT недоступен)
+    {
+        JitExpression jit(*ExpressionParser::parse("(2 + x) * 5 // y"));
+        std::cout << (jit.isNative() ? "native: " : "interpreted: ") << jit.evaluate({{"x", 3}, {"y", 2}});
+        try {
+            jit.evaluate({{"x", 3}, {"y", 0}});
+        } catch (const std::logic_error& e) {
+            std::cout << ", " << e.what();
+        }
+        std::cout << '\n';
+    }
+
+    // Инкрементальное вычисление: после смены x пересчитываются только
+    // узлы, зависящие от x
+    {
+        IncrementalEvaluator engine({{"x", 3}, {"y", 2}, {"z", 7}});
+        auto first = engine.addRoot(ExpressionParser::parse("(2 + x) * 5 // y"));
+        auto second = engine.addRoot(ExpressionParser::parse("(2 + x) * z - y"));
+        std::cout << "incremental: " << engine.value(first) << ' ' << engine.value(second);
+        size_t recomputed = engine.set("x", 4);
+        std::cout << " -> " << engine.value(first) << ' ' << engine.value(second)
+                  << " (" << recomputed << " of " << engine.nodeCount() << " nodes recomputed)\n";
+    }
+
+    // Интервальный анализ: при y в [1, 10] делитель y + 1 не бывает нулём,
+    // и компиляторы делят без проверок; y * 0 - ноль всегда
+    {
+        VariableBounds bounds{{"x", {-100, 100}}, {"y", {1, 10}}};
+        auto safe = ExpressionParser::parse("(x * 3) // (y + 1)");
+        RangeAnalysis ranges(*safe, bounds);
+        std::cout << "ranges: [" << ranges.result().lo << ", " << ranges.result().hi << "], "
+                  << ranges.safeDivisionCount() << " of " << ranges.divisionCount() << " divisions unchecked, "
+                  << BytecodeCompiler::compile(*safe, VariableLayout{"x", "y"}, ranges).run(std::vector<int>{50, 4});
+        auto faulty = ExpressionParser::parse("x // (y * 0)");
+        std::cout << "; ";
+        faulty->print(std::cout);
+        std::cout << (RangeAnalysis(*faulty, bounds).alwaysFaults() ? " always divides by zero\n" : " may not fault\n");
+    }
+
+    // Контекст по номерам символов: имена переводятся в номера один раз,
+    // при заполнении, и вычисление не трогает строк
+    {
+        auto rule = ExpressionParser::parse("(2 + x) * 5 // y");
+        SymbolContext symbols;
+        symbols.set("x", 3);
+        symbols.set(SymbolTable::instance().intern("y"), 2);
+        std::cout << "symbols: x = #" << *SymbolTable::instance().find("x") << ", y = #"
+                  << *SymbolTable::instance().find("y") << ", value " << rule->evaluate(symbols) << '\n';
+    }
+
+    // То же дерево над другими типами значения: семантика операций
+    // выбирается при компиляции через ValueTraits<V>
+    {
+        auto wide = std::make_shared<BasicMultiply<int64_t>>(
+            std::make_shared<BasicVariable<int64_t>>("x"), std::make_shared<BasicConstant<int64_t>>(3'000'000'000));
+        std::cout << "int64: " << wide->evaluate({{"x", 4}});
+
+        auto real = std::make_shared<BasicIntegerDivide<double>>(
+            std::make_shared<BasicVariable<double>>("x"), std::make_shared<BasicConstant<double>>(2.0));
+        std::cout << ", double: " << real->evaluate({{"x", 7.5}});
+
+        using Safe = Checked<int32_t>;
+        auto checked = std::make_shared<BasicAdd<Safe>>(
+            std::make_shared<BasicVariable<Safe>>("x"), std::make_shared<BasicConstant<Safe>>(1));
+        std::cout << ", checked: " << checked->evaluate({{"x", 41}});
+        try {
+            checked->evaluate({{"x", INT32_MAX}});
+        } catch (const std::overflow_error& e) {
+            std::cout << ", " << e.what();
+        }
+        std::cout << '\n';
+    }
+
+    // Связывание с раскладкой контекста: отсутствующая переменная
+    // обнаруживается сразу, а не посреди вычисления
+    VariableLayout layout{"x", "y"};
+    try {
+        BytecodeCompiler::compile(anotherExpr, layout);
+    } catch (const std::logic_error& e) {
+        std::cout << "bind error: " << e.what() << '\n';
+    }
+    layout.add("xx");
+    std::vector<int> context{1, 2, 39};  // x, y, xx
+    std::cout << "3 + xx = " << BytecodeCompiler::compile(anotherExpr, layout).run(context) << '\n';
 }
\ No newline at end of file